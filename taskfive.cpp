@@ -4,6 +4,22 @@
 #include <queue>
 #include <fstream>
 #include <iomanip>
+#include <set>
+#include <string>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <chrono>
+#include <sstream>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 using namespace std;
 
 struct Process {
@@ -12,156 +28,1364 @@ struct Process {
     int burst;
     int waiting;
     int remaining; 
+    int priority = 0;   // smaller runs first; used as the nice value by CFS
 };
 
 // printTable Helper Function: Prints the results of a scheduling algorithm in a formatted table
-void printTable(vector<Process> procs) {
-    cout << left << setw(8) << "PID" << setw(14) << "Arrival" << setw(12) << "Burst" << setw(14) << "Waiting" << endl;
-    cout << "------------------------------------------------" << endl;
-    for (int i = 0; i < procs.size(); i++) {
-        cout << left << setw(8) << procs[i].pid << setw(14) << procs[i].arrival << setw(12) << procs[i].burst << setw(14) << procs[i].waiting << endl;
+// - Rows follow "order" (indices into procs); "waiting" holds the waiting time of every process by index
+// - Rows are formatted into a buffer and written in 64 KB blocks rather than flushed one by one
+void printTable(const vector<Process>& procs, const vector<int>& order, const vector<int>& waiting, ostream& out = cout) {
+    string buffer;
+    char row[96];
+    buffer += "PID     Arrival       Burst       Waiting       \n";
+    buffer += "------------------------------------------------\n";
+    for (int k = 0; k < order.size(); k++) {
+        const Process& p = procs[order[k]];
+        buffer.append(row, snprintf(row, sizeof(row), "%-8d%-14d%-12d%-14d\n", p.pid, p.arrival, p.burst, waiting[order[k]]));
+        if (buffer.size() >= 65536) {
+            out.write(buffer.data(), buffer.size());
+            buffer.clear();
+        }
     }
+    out.write(buffer.data(), buffer.size());
+    out.flush();
 }
 
 // Sort Helper Functions 
 bool sortByArrival(Process a, Process b) { return a.arrival < b.arrival; }
 bool sortByBurst(Process a, Process b)   { return a.burst < b.burst; }
 
-// fcfs Function: Simulates First Come First Served scheduling
-// - Processes are executed in the order they arrive
-double fcfs(vector<Process> procs) {
-    // - Sort by arrival time so we process them in order
-    sort(procs.begin(), procs.end(), sortByArrival);
+// arrivalOrder Function: Indices of the processes sorted by arrival time
+// - Sorting indices with the same comparison leaves ties in the same order as sorting the processes themselves did
+vector<int> arrivalOrder(const vector<Process>& procs) {
+    vector<int> order(procs.size());
+    for (int i = 0; i < order.size(); i++)
+        order[i] = i;
+    sort(order.begin(), order.end(), [&](int a, int b) { return procs[a].arrival < procs[b].arrival; });
+    return order;
+}
 
-    int time = 0;
-    double totalWait = 0;
+// Event-Driven Engine
+// - Pending arrivals sit in a min-heap; whenever the CPU is free every process that has arrived by then moves
+//   to the ready queue of the policy, and an idle CPU jumps straight to the next arrival instead of ticking
+// - Each arrival and each dispatch is one heap operation, so a run is O(n log n)
+// - Times are long long: a million processes with long bursts overflow int
 
-    for (int i = 0; i < procs.size(); i++) {
-        // - If the CPU is idle before this process arrives, jump ahead to its arrival
-        if (time < procs[i].arrival)
-            time = procs[i].arrival;
+typedef pair<long long, int> Event;   // (time, key); smaller keys win ties
 
-        // - Waiting time is how long the process sat idle before getting the CPU
-        procs[i].waiting = time - procs[i].arrival;
-        time += procs[i].burst;
-        totalWait += procs[i].waiting;
+// ArrivalQueue Structure: min-heap of pending arrivals keyed by (arrival time, key)
+struct ArrivalQueue {
+    priority_queue<Event, vector<Event>, greater<Event>> heap;
+
+    // - "keys[i]" breaks ties between processes arriving together (their index when empty)
+    ArrivalQueue(const vector<Process>& procs, const vector<int>& keys) {
+        vector<Event> events(procs.size());
+        for (int i = 0; i < procs.size(); i++)
+            events[i] = Event(procs[i].arrival, keys.empty() ? i : keys[i]);
+        heap = priority_queue<Event, vector<Event>, greater<Event>>(greater<Event>(), move(events));
     }
 
-    cout << "\n--- FCFS ---" << endl;
-    printTable(procs);
+    bool empty() const { return heap.empty(); }
+    long long nextTime() const { return heap.top().first; }
 
-    double avg = totalWait / procs.size();
-    cout << "Average Waiting Time: " << avg << endl;
-    return avg;
+    // release Function: hands every process that has arrived by "time" to "ready", in (arrival, key) order
+    template <class Ready>
+    void release(long long time, Ready ready) {
+        while (!heap.empty() && heap.top().first <= time) {
+            ready(heap.top().second);
+            heap.pop();
+        }
+    }
+};
+
+// ScheduleStats Structure: what one simulated schedule produced, by process index
+// - start:  first time the process got the CPU (response time = start - arrival)
+// - finish: completion time (turnaround = finish - arrival, waiting = turnaround - burst)
+// - contextSwitches: dispatches of a different process than the one that ran last
+struct ScheduleStats {
+    vector<long long> start, finish;
+    long long contextSwitches = 0;
+    int last = -1;
+
+    void reset(int n) {
+        start.assign(n, -1);
+        finish.assign(n, 0);
+        contextSwitches = 0;
+        last = -1;
+    }
+
+    // dispatch Function: records that process i gets the CPU at "time"
+    void dispatch(int i, long long time) {
+        if (start[i] < 0)
+            start[i] = time;
+        if (last != -1 && last != i)
+            contextSwitches++;
+        last = i;
+    }
+};
+
+// waitingTimes Function: waiting time of every process, finish - arrival - burst
+vector<int> waitingTimes(const vector<Process>& procs, const ScheduleStats& stats) {
+    vector<int> waiting(procs.size());
+    for (int i = 0; i < procs.size(); i++)
+        waiting[i] = stats.finish[i] - procs[i].arrival - procs[i].burst;
+    return waiting;
 }
 
-// sjf Function: Simulates Shortest Job First scheduling (Non-Preemptive)
-// - Each time the CPU is free, the arrived process with the shortest burst time is chosen next
-double sjf(vector<Process> procs) {
+// simulateNonPreemptive Function: event loop for run-to-completion policies
+// - "ready" is the policy: push(key) adds an arrived process, pop() returns the key of the one to run next
+// - "keyToIndex" maps a key back to the process
+template <class ReadyQueue>
+void simulateNonPreemptive(const vector<Process>& procs, const vector<int>& keys, const vector<int>& keyToIndex,
+                           ReadyQueue& ready, ScheduleStats& stats) {
     int n = procs.size();
-    vector<bool> done(n, false);
-    int time = 0;
-    double totalWait = 0;
-    int finished = 0;
+    stats.reset(n);
+    ArrivalQueue arrivals(procs, keys);
+    long long time = 0;
 
-    while (finished < n) {
-        // - Scan all processes to find the shortest arrived job that hasn't run yet
-        int idx = -1;
-        for (int i = 0; i < n; i++) {
-            if (!done[i] && procs[i].arrival <= time) {
-                if (idx == -1 || procs[i].burst < procs[idx].burst)
-                    idx = i;
-            }
+    for (int finished = 0; finished < n; finished++) {
+        arrivals.release(time, [&](int key) { ready.push(key); });
+        // - Idle gap: jump to the next arrival
+        if (ready.empty()) {
+            time = max(time, arrivals.nextTime());
+            arrivals.release(time, [&](int key) { ready.push(key); });
         }
+        int i = keyToIndex[ready.pop()];
+        stats.dispatch(i, time);
+        time += procs[i].burst;
+        stats.finish[i] = time;
+    }
+}
 
-        // - No process is ready yet, advance time by 1
-        if (idx == -1) {
-            time++;
-            continue;
-        }
+// FifoReady Structure: ready queue in arrival order (FCFS)
+struct FifoReady {
+    queue<int> q;
+    void push(int key) { q.push(key); }
+    bool empty() const { return q.empty(); }
+    int pop() { int key = q.front(); q.pop(); return key; }
+};
 
-        procs[idx].waiting = time - procs[idx].arrival;
-        time += procs[idx].burst;
-        totalWait += procs[idx].waiting;
-        done[idx] = true;
-        finished++;
-    }
+// ShortestBurstReady Structure: ready queue as a min-heap keyed by (burst, index) (SJF)
+struct ShortestBurstReady {
+    const vector<Process>& procs;
+    priority_queue<Event, vector<Event>, greater<Event>> heap;
+    ShortestBurstReady(const vector<Process>& p) : procs(p) {}
+    void push(int i) { heap.push(Event(procs[i].burst, i)); }
+    bool empty() const { return heap.empty(); }
+    int pop() { int i = heap.top().second; heap.pop(); return i; }
+};
 
-    cout << "\n--- SJF ---" << endl;
-    printTable(procs);
+// simulateFCFS Function: First Come First Served; "order" is arrivalOrder(procs)
+// - The rank in "order" is the tie-break key, so processes arriving together run in the order fcfs prints them
+void simulateFCFS(const vector<Process>& procs, const vector<int>& order, ScheduleStats& stats) {
+    vector<int> rank(procs.size());
+    for (int k = 0; k < order.size(); k++)
+        rank[order[k]] = k;
+    FifoReady ready;
+    simulateNonPreemptive(procs, rank, order, ready, stats);
+}
 
-    double avg = totalWait / n;
-    cout << "Average Waiting Time: " << avg << endl;
-    return avg;
+// simulateSJF Function: non-preemptive Shortest Job First
+// - Among the arrived processes the shortest burst runs next, ties go to the lower index
+void simulateSJF(const vector<Process>& procs, ScheduleStats& stats) {
+    vector<int> identity(procs.size());
+    for (int i = 0; i < identity.size(); i++)
+        identity[i] = i;
+    ShortestBurstReady ready(procs);
+    simulateNonPreemptive(procs, {}, identity, ready, stats);
 }
 
-// roundRobin Function: Simulates Round Robin scheduling
-// - Each process gets a fixed time slice (quantum); if it doesn't finish it goes back to the queue
-double roundRobin(vector<Process> procs, int quantum) {
-    int n = procs.size();
-    sort(procs.begin(), procs.end(), sortByArrival);
+// RingQueue Structure: FIFO over a power-of-two circular buffer that doubles when full
+// - One contiguous block instead of std::deque's chunks, so walking a long ready queue is a linear scan
+template <class T>
+struct RingQueue {
+    vector<T> slots;
+    size_t head = 0, count = 0, mask;
+
+    RingQueue(size_t capacity = 16) {
+        size_t c = 16;
+        while (c < capacity)
+            c <<= 1;
+        slots.resize(c);
+        mask = c - 1;
+    }
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+    T& front() { return slots[head]; }
+    T& back() { return slots[(head + count - 1) & mask]; }
+    T& operator[](size_t k) { return slots[(head + k) & mask]; }
+    void pop_front() { head = (head + 1) & mask; count--; }
+    void pop_back() { count--; }
+
+    void push_back(const T& value) {
+        if (count == slots.size()) {
+            vector<T> bigger(slots.size() * 2);
+            for (size_t k = 0; k < count; k++)
+                bigger[k] = (*this)[k];
+            slots.swap(bigger);
+            head = 0;
+            mask = slots.size() - 1;
+        }
+        slots[(head + count++) & mask] = value;
+    }
+};
 
-    // - Initialise remaining burst times
+// simulateRoundRobin Function: Round Robin; "order" is arrivalOrder(procs)
+// - A process that used up its quantum goes back to the tail after the processes that arrived during its slice
+// - Fast forward: with k processes queued, r whole rounds in which nobody finishes and nobody arrives leave the
+//   queue in the same order with quantum * r less for each process, so they are applied in one O(k) pass:
+//   r = min over the queue of (remaining - 1) / quantum, and r * k * quantum must end before the next arrival
+// - When r is 0 (or an arrival is less than a round away) the next try waits k slices, by which time that round's
+//   finishers are gone, so the scans cost O(1) per slice; "fastForward" false runs every slice (the benchmark's
+//   reference)
+void simulateRoundRobin(const vector<Process>& procs, const vector<int>& order, int quantum, ScheduleStats& stats,
+                        bool fastForward = true) {
+    int n = procs.size();
+    vector<long long> remaining(n);
     for (int i = 0; i < n; i++)
-        procs[i].remaining = procs[i].burst;
+        remaining[i] = procs[i].burst;
 
-    queue<int> rq;          
-    vector<int> finishTime(n, 0);
-    int time = 0;
+    stats.reset(n);
+    RingQueue<int> rq(n);
+    int nextArrival = 0;   // arrivals are taken straight from "order", which is already sorted
+    auto release = [&](long long t) {
+        while (nextArrival < n && procs[order[nextArrival]].arrival <= t)
+            rq.push_back(order[nextArrival++]);
+    };
+    long long time = 0, slices = 0, nextTry = 0;
     int finished = 0;
-    int next = 0;           
-
-    rq.push(next);
-    next++;
 
+    release(time);
     while (finished < n) {
         // - If the queue is empty the CPU is idle, jump to the next arriving process
         if (rq.empty()) {
-            time = procs[next].arrival;
-            rq.push(next);
-            next++;
+            time = max(time, (long long)procs[order[nextArrival]].arrival);
+            release(time);
+        }
+
+        if (fastForward && slices >= nextTry) {
+            long long k = rq.size(), round = k * quantum;
+            long long horizon = nextArrival < n ? procs[order[nextArrival]].arrival - time - 1 : LLONG_MAX;
+            if (horizon >= round) {
+                long long rounds = horizon / round;
+                for (long long j = 0; j < k && rounds > 0; j++)
+                    rounds = min(rounds, (remaining[rq[j]] - 1) / quantum);
+                if (rounds > 0) {
+                    // - The first round dispatches rq[0..k-1] at quantum intervals, every dispatch after the
+                    //   first switches when k > 1, and the last one to run is the tail
+                    for (long long j = 0; j < k; j++) {
+                        int i = rq[j];
+                        if (stats.start[i] < 0)
+                            stats.start[i] = time + j * quantum;
+                        remaining[i] -= rounds * quantum;
+                    }
+                    if (stats.last != -1 && stats.last != rq[0])
+                        stats.contextSwitches++;
+                    if (k > 1)
+                        stats.contextSwitches += rounds * k - 1;
+                    stats.last = rq[k - 1];
+                    time += rounds * round;
+                    slices += rounds * k;
+                } else {
+                    nextTry = slices + k;
+                }
+            } else {
+                nextTry = slices + k;
+            }
         }
 
         int i = rq.front();
-        rq.pop();
+        rq.pop_front();
+        stats.dispatch(i, time);
+        slices++;
 
         // - Run the process for either the quantum or whatever it has left, whichever is smaller
-        int run = min(quantum, procs[i].remaining);
-        procs[i].remaining -= run;
+        long long run = min((long long)quantum, remaining[i]);
+        remaining[i] -= run;
         time += run;
 
         // - Enqueue any processes that arrived during this time slice
-        while (next < n && procs[next].arrival <= time) {
-            rq.push(next);
-            next++;
+        release(time);
+
+        if (remaining[i] == 0) {
+            stats.finish[i] = time;
+            finished++;
+        } else {
+            rq.push_back(i);
         }
+    }
+}
+
+// simulateSRTF Function: Shortest Remaining Time First (preemptive SJF)
+// - Ready processes sit in a min-heap keyed by (remaining, index); the running process is only looked at again
+//   at its completion or at the next arrival, and an arrival preempts it when it needs strictly less time
+void simulateSRTF(const vector<Process>& procs, ScheduleStats& stats) {
+    int n = procs.size();
+    stats.reset(n);
+    vector<long long> remaining(n);
+    for (int i = 0; i < n; i++)
+        remaining[i] = procs[i].burst;
+
+    ArrivalQueue arrivals(procs, {});
+    priority_queue<Event, vector<Event>, greater<Event>> ready;
+    auto enqueue = [&](int i) { ready.push(Event(remaining[i], i)); };
+    long long time = 0;
+    int current = -1, finished = 0;
 
-        if (procs[i].remaining == 0) {
-            finishTime[i] = time; 
+    while (finished < n) {
+        if (current == -1) {
+            arrivals.release(time, enqueue);
+            if (ready.empty()) {
+                time = max(time, arrivals.nextTime());
+                arrivals.release(time, enqueue);
+            }
+            current = ready.top().second;
+            ready.pop();
+            stats.dispatch(current, time);
+        }
+
+        long long end = time + remaining[current];
+        if (!arrivals.empty() && arrivals.nextTime() < end) {
+            // - Run up to the next arrival, then let the newcomers compete
+            long long next = arrivals.nextTime();
+            remaining[current] -= next - time;
+            time = next;
+            arrivals.release(time, enqueue);
+            if (ready.top().first < remaining[current]) {
+                enqueue(current);
+                current = -1;
+            }
+        } else {
+            time = end;
+            remaining[current] = 0;
+            stats.finish[current] = time;
             finished++;
+            current = -1;
+        }
+    }
+}
+
+// simulatePriority Function: preemptive priority scheduling with aging (a smaller priority value runs first)
+// - A waiting process gains one priority level per "agingInterval" time units, so its effective priority at time t
+//   is priority - (t - readySince) / agingInterval; comparing two of them at any t gives the same answer as
+//   comparing priority * agingInterval + readySince, a key that never changes, so a plain heap keeps the order
+// - With agingInterval 0 there is no aging: the key is (priority, readySince)
+// - An arrival preempts the running process when its priority is strictly better; aged processes win at the
+//   next dispatch, so nothing starves
+void simulatePriority(const vector<Process>& procs, int agingInterval, ScheduleStats& stats) {
+    int n = procs.size();
+    stats.reset(n);
+    vector<long long> remaining(n);
+    for (int i = 0; i < n; i++)
+        remaining[i] = procs[i].burst;
+
+    typedef pair<pair<long long, long long>, int> Entry;
+    priority_queue<Entry, vector<Entry>, greater<Entry>> ready;
+    long long time = 0;
+    auto enqueue = [&](int i) {
+        if (agingInterval > 0)
+            ready.push(Entry({(long long)procs[i].priority * agingInterval + time, 0}, i));
+        else
+            ready.push(Entry({procs[i].priority, time}, i));
+    };
+
+    ArrivalQueue arrivals(procs, {});
+    int current = -1, finished = 0;
+    while (finished < n) {
+        if (current == -1) {
+            arrivals.release(time, enqueue);
+            if (ready.empty()) {
+                time = max(time, arrivals.nextTime());
+                arrivals.release(time, enqueue);
+            }
+            current = ready.top().second;
+            ready.pop();
+            stats.dispatch(current, time);
+        }
+
+        long long end = time + remaining[current];
+        if (!arrivals.empty() && arrivals.nextTime() < end) {
+            long long next = arrivals.nextTime();
+            remaining[current] -= next - time;
+            time = next;
+            bool preempt = false;
+            arrivals.release(time, [&](int i) {
+                preempt = preempt || procs[i].priority < procs[current].priority;
+                enqueue(i);
+            });
+            if (preempt) {
+                enqueue(current);
+                current = -1;
+            }
         } else {
-            rq.push(i); 
+            time = end;
+            remaining[current] = 0;
+            stats.finish[current] = time;
+            finished++;
+            current = -1;
         }
     }
+}
 
-    // - Waiting time = finish time - arrival time - burst time
+// simulateMLFQ Function: Multi-Level Feedback Queue with "levels" round-robin queues
+// - Level l has a quantum of baseQuantum << l; arrivals enter level 0, a process that uses up its quantum on a
+//   level moves one level down (the last level is plain round robin)
+// - Time used on a level is kept across preemptions, so yielding just before the quantum ends does not help
+// - An arrival preempts a process running below level 0; every "boostPeriod" time units (0: never) all processes
+//   move back to level 0 so long jobs cannot starve
+// - The levels are linked lists threaded through "next", so a boost splices them onto level 0 in O(levels);
+//   queued processes pick up their reset level and allotment lazily when dispatched (boostSeen < boosts)
+void simulateMLFQ(const vector<Process>& procs, int levels, int baseQuantum, int boostPeriod, ScheduleStats& stats) {
+    int n = procs.size();
+    stats.reset(n);
+    vector<long long> remaining(n), used(n, 0);
+    vector<int> level(n, 0), next(n, -1), boostSeen(n, 0);
     for (int i = 0; i < n; i++)
-        procs[i].waiting = finishTime[i] - procs[i].arrival - procs[i].burst;
+        remaining[i] = procs[i].burst;
+
+    vector<int> head(levels, -1), tail(levels, -1);
+    auto push = [&](int l, int i) {
+        next[i] = -1;
+        if (tail[l] == -1) head[l] = i;
+        else next[tail[l]] = i;
+        tail[l] = i;
+    };
+    auto quantumOf = [&](int l) { return (long long)baseQuantum << l; };
+    ArrivalQueue arrivals(procs, {});
+    long long time = 0;
+    long long nextBoost = boostPeriod > 0 ? boostPeriod : LLONG_MAX;
+    int current = -1, finished = 0, boosts = 0;
+    auto enqueue = [&](int i) { boostSeen[i] = boosts; push(0, i); };
+
+    while (finished < n) {
+        if (current == -1) {
+            arrivals.release(time, enqueue);
+            int l = 0;
+            while (l < levels && head[l] == -1)
+                l++;
+            if (l == levels) {
+                time = max(time, arrivals.nextTime());
+                arrivals.release(time, enqueue);
+                l = 0;
+                // - Nothing was queued while idle, so missed boosts do not matter
+                if (boostPeriod > 0 && nextBoost <= time)
+                    nextBoost = (time / boostPeriod + 1) * boostPeriod;
+            }
+            current = head[l];
+            head[l] = next[current];
+            if (head[l] == -1)
+                tail[l] = -1;
+            if (boostSeen[current] < boosts) {
+                boostSeen[current] = boosts;
+                level[current] = 0;
+                used[current] = 0;
+            }
+            stats.dispatch(current, time);
+        }
+
+        // - Run until the first of: completion, end of quantum, a boost, or (below level 0) the next arrival
+        long long end = time + min(remaining[current], quantumOf(level[current]) - used[current]);
+        if (boostPeriod > 0)
+            end = min(end, nextBoost);
+        if (level[current] > 0 && !arrivals.empty())
+            end = min(end, max(time, arrivals.nextTime()));
+        remaining[current] -= end - time;
+        used[current] += end - time;
+        time = end;
+        arrivals.release(time, enqueue);
+
+        if (remaining[current] == 0) {
+            stats.finish[current] = time;
+            finished++;
+            current = -1;
+        } else if (used[current] == quantumOf(level[current])) {
+            level[current] = min(level[current] + 1, levels - 1);
+            used[current] = 0;
+            push(level[current], current);
+            current = -1;
+        } else if (level[current] > 0 && head[0] != -1) {
+            push(level[current], current);
+            current = -1;
+        }
+
+        // - Boost: splice every level onto level 0 in order, the running process keeps the CPU at level 0
+        if (time >= nextBoost) {
+            boosts++;
+            for (int l = 1; l < levels; l++) {
+                if (head[l] == -1)
+                    continue;
+                if (tail[0] == -1) head[0] = head[l];
+                else next[tail[0]] = head[l];
+                tail[0] = tail[l];
+                head[l] = tail[l] = -1;
+            }
+            if (current != -1) {
+                boostSeen[current] = boosts;
+                level[current] = 0;
+                used[current] = 0;
+            }
+            nextBoost += boostPeriod;
+        }
+    }
+}
+
+// simulateCFS Function: a CFS-like fair scheduler
+// - Ready processes sit in a std::set (a red-black tree) ordered by (vruntime, index); the leftmost runs next
+// - The priority is a nice value (-20..19): the weight is 1024 / 1.25^nice and vruntime advances by
+//   run * 1024 / weight, so heavier processes get proportionally more CPU
+// - A slice is targetLatency * weight / total weight, at least minGranularity; arrivals start at the smallest
+//   vruntime in the tree and wait for the current slice to end (no wakeup preemption)
+void simulateCFS(const vector<Process>& procs, int targetLatency, int minGranularity, ScheduleStats& stats) {
+    int n = procs.size();
+    stats.reset(n);
+    vector<long long> remaining(n);
+    vector<double> vruntime(n, 0), weight(n);
+    for (int i = 0; i < n; i++) {
+        remaining[i] = procs[i].burst;
+        weight[i] = 1024.0 / pow(1.25, max(-20, min(19, procs[i].priority)));
+    }
+
+    set<pair<double, int>> tree;
+    double totalWeight = 0, minVruntime = 0;
+    auto enqueue = [&](int i) {
+        vruntime[i] = max(vruntime[i], minVruntime);
+        tree.insert({vruntime[i], i});
+        totalWeight += weight[i];
+    };
 
+    ArrivalQueue arrivals(procs, {});
+    long long time = 0;
+    int finished = 0;
+    while (finished < n) {
+        arrivals.release(time, enqueue);
+        if (tree.empty()) {
+            time = max(time, arrivals.nextTime());
+            arrivals.release(time, enqueue);
+        }
+        int i = tree.begin()->second;
+        tree.erase(tree.begin());
+        stats.dispatch(i, time);
+
+        long long slice = max((long long)minGranularity, (long long)(targetLatency * weight[i] / totalWeight));
+        long long run = min(max(1LL, slice), remaining[i]);
+        remaining[i] -= run;
+        time += run;
+        vruntime[i] += run * 1024.0 / weight[i];
+        minVruntime = tree.empty() ? vruntime[i] : min(vruntime[i], tree.begin()->first);
+
+        if (remaining[i] == 0) {
+            stats.finish[i] = time;
+            totalWeight -= weight[i];
+            finished++;
+        } else {
+            totalWeight -= weight[i];
+            enqueue(i);
+        }
+    }
+}
+
+// averageWaiting Function: mean of the waiting times
+double averageWaiting(const vector<int>& waiting) {
     double totalWait = 0;
-    for (int i = 0; i < n; i++)
-        totalWait += procs[i].waiting;
+    for (int i = 0; i < waiting.size(); i++)
+        totalWait += waiting[i];
+    return totalWait / waiting.size();
+}
+
+// reportSchedule Helper Function: prints the table and average waiting time of one schedule, returns the average
+double reportSchedule(const string& title, const vector<Process>& procs, const vector<int>& order, const ScheduleStats& stats) {
+    vector<int> waiting = waitingTimes(procs, stats);
 
-    cout << "\n--- Round Robin (quantum = " << quantum << ") ---" << endl;
-    printTable(procs);
+    cout << "\n--- " << title << " ---" << endl;
+    printTable(procs, order, waiting);
 
-    double avg = totalWait / n;
+    double avg = averageWaiting(waiting);
     cout << "Average Waiting Time: " << avg << endl;
     return avg;
 }
 
+// inputOrder Helper Function: 0, 1, ..., n - 1
+vector<int> inputOrder(int n) {
+    vector<int> order(n);
+    for (int i = 0; i < n; i++)
+        order[i] = i;
+    return order;
+}
+
+// fcfs Function: Simulates First Come First Served scheduling
+// - Processes are executed in the order they arrive
+double fcfs(const vector<Process>& procs, ScheduleStats& stats) {
+    vector<int> order = arrivalOrder(procs);
+    simulateFCFS(procs, order, stats);
+    return reportSchedule("FCFS", procs, order, stats);
+}
+
+// sjf Function: Simulates Shortest Job First scheduling (Non-Preemptive)
+// - Each time the CPU is free, the arrived process with the shortest burst time is chosen next
+double sjf(const vector<Process>& procs, ScheduleStats& stats) {
+    simulateSJF(procs, stats);
+    return reportSchedule("SJF", procs, inputOrder(procs.size()), stats);
+}
+
+// roundRobin Function: Simulates Round Robin scheduling
+// - Each process gets a fixed time slice (quantum); if it doesn't finish it goes back to the queue
+double roundRobin(const vector<Process>& procs, int quantum, ScheduleStats& stats) {
+    vector<int> order = arrivalOrder(procs);
+    simulateRoundRobin(procs, order, quantum, stats);
+    return reportSchedule("Round Robin (quantum = " + to_string(quantum) + ")", procs, order, stats);
+}
+
+// srtf Function: Simulates Shortest Remaining Time First scheduling (Preemptive SJF)
+double srtf(const vector<Process>& procs, ScheduleStats& stats) {
+    simulateSRTF(procs, stats);
+    return reportSchedule("SRTF", procs, inputOrder(procs.size()), stats);
+}
+
+// priorityAging Function: Simulates preemptive priority scheduling with aging
+double priorityAging(const vector<Process>& procs, int agingInterval, ScheduleStats& stats) {
+    simulatePriority(procs, agingInterval, stats);
+    return reportSchedule("Priority (aging interval = " + to_string(agingInterval) + ")", procs, inputOrder(procs.size()), stats);
+}
+
+// mlfq Function: Simulates a Multi-Level Feedback Queue
+double mlfq(const vector<Process>& procs, int levels, int quantum, int boostPeriod, ScheduleStats& stats) {
+    simulateMLFQ(procs, levels, quantum, boostPeriod, stats);
+    return reportSchedule("MLFQ (" + to_string(levels) + " levels, base quantum = " + to_string(quantum) +
+                          ", boost = " + to_string(boostPeriod) + ")", procs, inputOrder(procs.size()), stats);
+}
+
+// cfs Function: Simulates a CFS-like fair scheduler
+double cfs(const vector<Process>& procs, int targetLatency, int minGranularity, ScheduleStats& stats) {
+    simulateCFS(procs, targetLatency, minGranularity, stats);
+    return reportSchedule("CFS (latency = " + to_string(targetLatency) + ", granularity = " + to_string(minGranularity) + ")",
+                          procs, inputOrder(procs.size()), stats);
+}
+
+// percentile Function: the q-quantile (0..1) of "values", nearest rank
+long long percentile(vector<long long> values, double q) {
+    if (values.empty())
+        return 0;
+    size_t k = min(values.size() - 1, (size_t)(q * values.size()));
+    nth_element(values.begin(), values.begin() + k, values.end());
+    return values[k];
+}
+
+// printMetrics Function: one row per policy - averages of waiting, turnaround and response time, turnaround and
+// response percentiles, and context switches
+void printMetrics(const vector<Process>& procs, const vector<string>& names, const vector<ScheduleStats>& results) {
+    cout << "\n=== Metrics ===" << endl;
+    cout << left << setw(14) << "Policy" << setw(10) << "Wait" << setw(12) << "Turnaround" << setw(10) << "Response"
+         << setw(10) << "TA p50" << setw(10) << "TA p95" << setw(10) << "TA p99" << setw(10) << "Resp p99"
+         << "Switches" << endl;
+    cout << string(94, '-') << endl;
+    int n = procs.size();
+    for (int k = 0; k < names.size(); k++) {
+        const ScheduleStats& s = results[k];
+        vector<long long> turnaround(n), response(n);
+        double wait = 0, ta = 0, resp = 0;
+        for (int i = 0; i < n; i++) {
+            turnaround[i] = s.finish[i] - procs[i].arrival;
+            response[i] = s.start[i] - procs[i].arrival;
+            wait += turnaround[i] - procs[i].burst;
+            ta += turnaround[i];
+            resp += response[i];
+        }
+        cout << left << fixed << setprecision(2) << setw(14) << names[k] << setw(10) << wait / n << setw(12) << ta / n
+             << setw(10) << resp / n << setw(10) << percentile(turnaround, 0.50) << setw(10) << percentile(turnaround, 0.95)
+             << setw(10) << percentile(turnaround, 0.99) << setw(10) << percentile(response, 0.99) << s.contextSwitches << endl;
+    }
+}
+
+// Multi-Core Simulation
+// - Every core has its own run queue (a RingQueue) and its own clock; a min-heap of (time, core) says which core
+//   reaches the end of its slice next, and arrivals due by then are placed first, so one loop keeps all cores in
+//   step without ticking
+// - Arrivals go to the core with the least work queued (running + waiting), a preempted process goes back to the
+//   queue of the core it ran on, and a core that runs dry steals from the tail of the longest queue
+// - With affinity every process is pinned to core index % cpus: no balancing, no stealing, no migrations
+// - With one core this is exactly simulateRoundRobin (or simulateFCFS when the quantum is 0)
+
+// MultiCoreOptions Structure: knobs of the N-CPU simulation
+struct MultiCoreOptions {
+    int cpus = 4;
+    int quantum = 0;        // 0: a process runs to completion once dispatched
+    bool steal = true;      // idle cores take work from the longest run queue
+    bool affinity = false;  // pin process i to core i % cpus
+};
+
+// MultiCoreStats Structure: result of a multi-core run
+// - schedule.contextSwitches sums the switches of every core
+// - busy / dispatches / steals are per core; a migration is a dispatch on a different core than the process last ran on
+struct MultiCoreStats {
+    ScheduleStats schedule;
+    vector<long long> busy, dispatches, steals;
+    long long migrations = 0, makespan = 0;
+};
+
+// simulateMultiCore Function: N-CPU Round Robin (FCFS with quantum 0) with per-CPU run queues; "order" is arrivalOrder(procs)
+// - Queue entries carry the state a dispatch needs (remaining time, last core), so cycling through a long run
+//   queue reads it sequentially instead of jumping around per-process arrays
+void simulateMultiCore(const vector<Process>& procs, const vector<int>& order, const MultiCoreOptions& opt, MultiCoreStats& out) {
+    int n = procs.size(), cpus = opt.cpus;
+    struct Entry { long long remaining; int index, lastCore; };   // lastCore -1: never ran
+
+    ScheduleStats& stats = out.schedule;
+    stats.reset(n);
+    out.busy.assign(cpus, 0);
+    out.dispatches.assign(cpus, 0);
+    out.steals.assign(cpus, 0);
+    out.migrations = 0;
+
+    vector<RingQueue<Entry>> rq(cpus);
+    vector<Entry> running(cpus, {0, -1, -1});
+    vector<int> lastRun(cpus, -1), load(cpus, 0);   // load: queued + running
+    vector<long long> sliceLength(cpus, 0);
+    vector<bool> pending(cpus, false);   // the core has an event in the heap
+    priority_queue<Event, vector<Event>, greater<Event>> cores;
+    long long time = 0;
+    int finished = 0, nextArrival = 0;   // arrivals are consumed straight from "order", which is already sorted
+    long long queued = 0;                // entries in all run queues; nothing to steal when 0
+
+    // - place: an arrival joins the least loaded core (or its pinned core); an idle core starts right away
+    auto place = [&](int i) {
+        int c = 0;
+        if (opt.affinity) {
+            c = i % cpus;
+        } else {
+            for (int k = 1; k < cpus; k++)
+                if (load[k] < load[c])
+                    c = k;
+        }
+        rq[c].push_back({procs[i].burst, i, -1});
+        load[c]++;
+        queued++;
+        if (!pending[c]) {
+            pending[c] = true;
+            cores.push(Event(time, c));
+        }
+    };
+
+    while (finished < n) {
+        // - Arrivals due no later than the next core event go first, so they queue ahead of a preempted process
+        if (nextArrival < n && (cores.empty() || procs[order[nextArrival]].arrival <= cores.top().first)) {
+            time = procs[order[nextArrival]].arrival;
+            while (nextArrival < n && procs[order[nextArrival]].arrival == time)
+                place(order[nextArrival++]);
+            continue;
+        }
+
+        time = cores.top().first;
+        int c = cores.top().second;
+        cores.pop();
+
+        Entry& done = running[c];
+        if (done.index != -1) {
+            done.remaining -= sliceLength[c];
+            if (done.remaining == 0) {
+                stats.finish[done.index] = time;
+                finished++;
+                load[c]--;
+            } else {
+                rq[c].push_back(done);
+                queued++;
+            }
+            done.index = -1;
+        }
+
+        if (rq[c].empty() && queued > 0 && opt.steal && !opt.affinity) {
+            int victim = -1;
+            size_t longest = 0;
+            for (int k = 0; k < cpus; k++) {
+                if (rq[k].size() > longest) {
+                    longest = rq[k].size();
+                    victim = k;
+                }
+            }
+            if (victim != -1) {
+                rq[c].push_back(rq[victim].back());
+                rq[victim].pop_back();
+                load[victim]--;
+                load[c]++;
+                out.steals[c]++;
+            }
+        }
+
+        if (rq[c].empty()) {
+            pending[c] = false;
+            continue;
+        }
+
+        Entry e = rq[c].front();
+        rq[c].pop_front();
+        queued--;
+        if (e.lastCore == -1)
+            stats.start[e.index] = time;
+        else if (e.lastCore != c)
+            out.migrations++;
+        if (lastRun[c] != -1 && lastRun[c] != e.index)
+            stats.contextSwitches++;
+        lastRun[c] = e.index;
+        e.lastCore = c;
+        out.dispatches[c]++;
+
+        long long run = opt.quantum > 0 ? min((long long)opt.quantum, e.remaining) : e.remaining;
+        running[c] = e;
+        sliceLength[c] = run;
+        out.busy[c] += run;
+        cores.push(Event(time + run, c));
+    }
+    out.makespan = time;
+}
+
+// printMultiCore Function: per-core utilization table, migrations and the waiting-time distribution of one run
+// - "row" only prints a single summary line, for sweeps over core counts
+void printMultiCore(const vector<Process>& procs, const MultiCoreOptions& opt, const MultiCoreStats& s, double ms, bool row) {
+    int n = procs.size();
+    vector<long long> waiting(n);
+    double avg = 0, totalBusy = 0, totalSteals = 0;
+    for (int i = 0; i < n; i++) {
+        waiting[i] = s.schedule.finish[i] - procs[i].arrival - procs[i].burst;
+        avg += waiting[i];
+    }
+    avg /= n;
+    sort(waiting.begin(), waiting.end());
+    auto at = [&](double q) { return waiting[min(n - 1, (int)(q * n))]; };
+    for (int c = 0; c < opt.cpus; c++) {
+        totalBusy += s.busy[c];
+        totalSteals += s.steals[c];
+    }
+    double span = max(1LL, s.makespan);
+
+    if (row) {
+        cout << left << fixed << setprecision(2) << setw(8) << opt.cpus << setw(12) << avg << setw(10) << at(0.50)
+             << setw(10) << at(0.90) << setw(10) << at(0.99) << setw(12) << waiting[n - 1]
+             << setw(10) << 100.0 * totalBusy / (span * opt.cpus) << setw(12) << s.migrations
+             << setw(10) << (long long)totalSteals << ms << endl;
+        return;
+    }
+
+    cout << "\n--- " << opt.cpus << " CPUs, " << (opt.quantum > 0 ? "Round Robin (quantum = " + to_string(opt.quantum) + ")" : string("FCFS"))
+         << (opt.affinity ? ", pinned" : opt.steal ? ", work stealing" : ", no stealing") << " ---" << endl;
+    cout << left << setw(8) << "Core" << setw(14) << "Busy" << setw(14) << "Utilization" << setw(14) << "Dispatches"
+         << "Steals" << endl;
+    cout << "------------------------------------------------------------" << endl;
+    for (int c = 0; c < opt.cpus; c++)
+        cout << left << fixed << setprecision(2) << setw(8) << c << setw(14) << s.busy[c] << setw(14) << 100.0 * s.busy[c] / span
+             << setw(14) << s.dispatches[c] << s.steals[c] << endl;
+    cout << "Makespan: " << s.makespan << "  Migrations: " << s.migrations << "  Context switches: "
+         << s.schedule.contextSwitches << "  Simulated in " << ms << " ms" << endl;
+    cout << "Waiting time: avg " << avg << "  p50 " << at(0.50) << "  p90 " << at(0.90) << "  p99 " << at(0.99)
+         << "  p99.9 " << at(0.999) << "  max " << waiting[n - 1] << endl;
+}
+
+// Workloads From Files And Generators
+// - A trace has one process per line: "arrival burst [priority]"; blank lines and lines starting with '#' are
+//   skipped and the PID is the row number
+// - The generator draws Poisson arrivals (exponential gaps at "rate" processes per time unit) and Pareto
+//   bursts (shape "alpha", at least "minBurst", capped at "maxBurst"), the heavy tail real job traces show
+
+// readTraceMapped Function: Reads a trace through a memory mapping with a hand-rolled parser
+bool readTraceMapped(const string& filename, vector<Process>& procs) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        cerr << "Error: Could not open file '" << filename << "'" << endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        cerr << "Error: '" << filename << "' is empty" << endl;
+        return false;
+    }
+    void* mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        cerr << "Error: Could not map file '" << filename << "'" << endl;
+        return false;
+    }
+    madvise(mapping, st.st_size, MADV_SEQUENTIAL);
+    const char* p = (const char*)mapping;
+    const char* end = p + st.st_size;
+
+    procs.clear();
+    procs.reserve(st.st_size / 8);
+    long long line = 0;
+    bool ok = true;
+    while (ok && p < end) {
+        line++;
+        const char* eol = (const char*)memchr(p, '\n', end - p);
+        if (eol == nullptr)
+            eol = end;
+
+        // - Up to three integers per line; anything after them is ignored
+        long long values[3];
+        int count = 0;
+        while (p < eol && count < 3) {
+            while (p < eol && (*p == ' ' || *p == '\t' || *p == ',' || *p == '\r'))
+                p++;
+            if (p == eol || *p == '#')
+                break;
+            bool negative = *p == '-';
+            if (negative)
+                p++;
+            if (p == eol || *p < '0' || *p > '9') {
+                ok = false;
+                break;
+            }
+            long long v = 0;
+            while (p < eol && *p >= '0' && *p <= '9')
+                v = v * 10 + (*p++ - '0');
+            values[count++] = negative ? -v : v;
+        }
+
+        if (ok && count == 1)
+            ok = false;
+        if (ok && count >= 2) {
+            if (values[0] < 0 || values[1] < 0 || values[0] > INT_MAX || values[1] > INT_MAX) {
+                ok = false;
+            } else {
+                Process proc;
+                proc.pid = procs.size() + 1;
+                proc.arrival = values[0];
+                proc.burst = values[1];
+                proc.waiting = 0;
+                proc.remaining = proc.burst;
+                proc.priority = count == 3 ? (int)values[2] : 0;
+                procs.push_back(proc);
+            }
+        }
+        p = eol + 1;
+    }
+    munmap(mapping, st.st_size);
+    if (!ok) {
+        cerr << "Error: '" << filename << "' line " << line << " is not \"arrival burst [priority]\"" << endl;
+        return false;
+    }
+    if (procs.empty()) {
+        cerr << "Error: '" << filename << "' holds no processes" << endl;
+        return false;
+    }
+    return true;
+}
+
+// generateWorkload Function: "n" processes with Poisson arrivals and Pareto bursts, reproducible from "seed"
+// - Priorities are uniform in 0..9
+void generateWorkload(int n, unsigned int seed, double rate, double alpha, int minBurst, int maxBurst, vector<Process>& procs) {
+    mt19937_64 rng(seed);
+    exponential_distribution<double> gap(rate);
+    uniform_real_distribution<double> unit(0.0, 1.0);
+    procs.resize(n);
+    double t = 0;
+    for (int i = 0; i < n; i++) {
+        t += gap(rng);
+        double u = 1.0 - unit(rng);   // (0, 1]
+        double burst = ceil(minBurst / pow(u, 1.0 / alpha));
+        procs[i].pid = i + 1;
+        procs[i].arrival = (int)min(t, (double)INT_MAX);
+        procs[i].burst = (int)min(burst, (double)maxBurst);
+        procs[i].waiting = 0;
+        procs[i].remaining = procs[i].burst;
+        procs[i].priority = rng() % 10;
+    }
+}
+
+// writeTraceFile Function: Writes processes in the format readTraceMapped reads
+bool writeTraceFile(const string& filename, const vector<Process>& procs) {
+    FILE* out = fopen(filename.c_str(), "w");
+    if (out == nullptr) {
+        cerr << "Error: Could not create file '" << filename << "'" << endl;
+        return false;
+    }
+    fprintf(out, "# arrival burst priority\n");
+    for (const Process& p : procs)
+        fprintf(out, "%d %d %d\n", p.arrival, p.burst, p.priority);
+    bool ok = !ferror(out);
+    fclose(out);
+    return ok;
+}
+
+// Parameter Sweeps
+// - A sweep is a list of jobs (policy, quantum, core count) run on a pool of threads; every simulator only reads
+//   the process list, so the jobs share it
+// - Each job reduces its schedule to one summary row right away, so memory stays at one schedule per thread
+
+// PolicyOptions Structure: knobs of the policies beyond FCFS, SJF and Round Robin
+struct PolicyOptions {
+    int agingInterval = 10;
+    int mlfqLevels = 3;
+    int boostPeriod = 0;
+    int targetLatency = 20;
+    int minGranularity = 4;
+};
+
+// SweepJob Structure: one run of a sweep; cpus > 1 uses the multi-core simulator (fcfs and rr only)
+struct SweepJob {
+    string policy;
+    int quantum;
+    int cpus;
+};
+
+// SweepResult Structure: summary of one run, plus its per-process table when tables are on
+struct SweepResult {
+    double avgWait = 0, avgTurnaround = 0, avgResponse = 0;
+    long long p50 = 0, p95 = 0, p99 = 0, maxWait = 0;   // waiting time distribution
+    long long contextSwitches = 0, migrations = 0;
+    double ms = 0;
+    string table;
+};
+
+// sweepLabel Function: readable name of a job, e.g. "rr q=4 x8"
+string sweepLabel(const SweepJob& job) {
+    string label = job.policy;
+    if (job.policy == "rr" || job.policy == "mlfq")
+        label += " q=" + to_string(job.quantum);
+    if (job.cpus > 1)
+        label += " x" + to_string(job.cpus);
+    return label;
+}
+
+// runSweepJob Function: simulates one job and summarizes it; "order" is arrivalOrder(procs)
+SweepResult runSweepJob(const vector<Process>& procs, const vector<int>& order, const SweepJob& job,
+                        const PolicyOptions& options, const MultiCoreOptions& multi, bool tables) {
+    SweepResult r;
+    ScheduleStats stats;
+    MultiCoreStats multiStats;
+    auto t0 = chrono::steady_clock::now();
+    if (job.cpus > 1) {
+        MultiCoreOptions o = multi;
+        o.cpus = job.cpus;
+        o.quantum = job.policy == "rr" ? job.quantum : 0;
+        simulateMultiCore(procs, order, o, multiStats);
+        stats = move(multiStats.schedule);
+        r.migrations = multiStats.migrations;
+    }
+    else if (job.policy == "fcfs")     simulateFCFS(procs, order, stats);
+    else if (job.policy == "sjf")      simulateSJF(procs, stats);
+    else if (job.policy == "rr")       simulateRoundRobin(procs, order, job.quantum, stats);
+    else if (job.policy == "srtf")     simulateSRTF(procs, stats);
+    else if (job.policy == "priority") simulatePriority(procs, options.agingInterval, stats);
+    else if (job.policy == "mlfq")     simulateMLFQ(procs, options.mlfqLevels, job.quantum, options.boostPeriod, stats);
+    else                               simulateCFS(procs, options.targetLatency, options.minGranularity, stats);
+    r.ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+
+    int n = procs.size();
+    vector<long long> waiting(n);
+    for (int i = 0; i < n; i++) {
+        long long turnaround = stats.finish[i] - procs[i].arrival;
+        waiting[i] = turnaround - procs[i].burst;
+        r.avgWait += waiting[i];
+        r.avgTurnaround += turnaround;
+        r.avgResponse += stats.start[i] - procs[i].arrival;
+    }
+    r.avgWait /= n;
+    r.avgTurnaround /= n;
+    r.avgResponse /= n;
+    r.contextSwitches = stats.contextSwitches;
+
+    if (tables) {
+        ostringstream out;
+        out << "\n--- " << sweepLabel(job) << " ---" << endl;
+        vector<int> rows = job.policy == "fcfs" || job.policy == "rr" ? order : inputOrder(n);
+        printTable(procs, rows, waitingTimes(procs, stats), out);
+        out << "Average Waiting Time: " << r.avgWait << endl;
+        r.table = out.str();
+    }
+
+    sort(waiting.begin(), waiting.end());
+    r.p50 = waiting[min(n - 1, (int)(0.50 * n))];
+    r.p95 = waiting[min(n - 1, (int)(0.95 * n))];
+    r.p99 = waiting[min(n - 1, (int)(0.99 * n))];
+    r.maxWait = waiting[n - 1];
+    return r;
+}
+
+// runSweep Function: runs every job on "numThreads" threads, results in job order
+vector<SweepResult> runSweep(const vector<Process>& procs, const vector<SweepJob>& jobs, const PolicyOptions& options,
+                             const MultiCoreOptions& multi, bool tables, int numThreads) {
+    vector<int> order = arrivalOrder(procs);
+    vector<SweepResult> results(jobs.size());
+    atomic<int> nextJob(0);
+    vector<thread> workers;
+    for (int w = 0; w < max(1, min(numThreads, (int)jobs.size())); w++) {
+        workers.push_back(thread([&] {
+            int k;
+            while ((k = nextJob++) < (int)jobs.size())
+                results[k] = runSweepJob(procs, order, jobs[k], options, multi, tables);
+        }));
+    }
+    for (auto& worker : workers)
+        worker.join();
+    return results;
+}
+
+// printSweep Function: the summary rows as a table
+void printSweep(const vector<SweepJob>& jobs, const vector<SweepResult>& results) {
+    cout << left << setw(16) << "Run" << setw(14) << "Avg wait" << setw(14) << "Turnaround" << setw(14) << "Response"
+         << setw(12) << "p50 wait" << setw(12) << "p95 wait" << setw(12) << "p99 wait" << setw(12) << "Max wait"
+         << setw(12) << "Switches" << setw(12) << "Migrations" << "ms" << endl;
+    cout << string(146, '-') << endl;
+    for (int k = 0; k < jobs.size(); k++) {
+        const SweepResult& r = results[k];
+        cout << left << fixed << setprecision(2) << setw(16) << sweepLabel(jobs[k]) << setw(14) << r.avgWait
+             << setw(14) << r.avgTurnaround << setw(14) << r.avgResponse << setw(12) << r.p50 << setw(12) << r.p95
+             << setw(12) << r.p99 << setw(12) << r.maxWait << setw(12) << r.contextSwitches << setw(12) << r.migrations
+             << r.ms << endl;
+    }
+}
+
+// writeSweep Function: the summary rows as CSV or JSON, to "filename" or to stdout for "-"
+bool writeSweep(const string& filename, bool json, const vector<SweepJob>& jobs, const vector<SweepResult>& results) {
+    FILE* out = filename == "-" ? stdout : fopen(filename.c_str(), "w");
+    if (out == nullptr) {
+        cerr << "Error: Could not create file '" << filename << "'" << endl;
+        return false;
+    }
+    if (json)
+        fprintf(out, "[\n");
+    else
+        fprintf(out, "policy,quantum,cpus,avg_wait,avg_turnaround,avg_response,p50_wait,p95_wait,p99_wait,max_wait,"
+                     "context_switches,migrations,ms\n");
+    for (int k = 0; k < jobs.size(); k++) {
+        const SweepJob& j = jobs[k];
+        const SweepResult& r = results[k];
+        if (json)
+            fprintf(out, "  {\"policy\": \"%s\", \"quantum\": %d, \"cpus\": %d, \"avg_wait\": %.3f, \"avg_turnaround\": %.3f, "
+                         "\"avg_response\": %.3f, \"p50_wait\": %lld, \"p95_wait\": %lld, \"p99_wait\": %lld, \"max_wait\": %lld, "
+                         "\"context_switches\": %lld, \"migrations\": %lld, \"ms\": %.3f}%s\n",
+                    j.policy.c_str(), j.quantum, j.cpus, r.avgWait, r.avgTurnaround, r.avgResponse, r.p50, r.p95, r.p99,
+                    r.maxWait, r.contextSwitches, r.migrations, r.ms, k + 1 < jobs.size() ? "," : "");
+        else
+            fprintf(out, "%s,%d,%d,%.3f,%.3f,%.3f,%lld,%lld,%lld,%lld,%lld,%lld,%.3f\n", j.policy.c_str(), j.quantum, j.cpus,
+                    r.avgWait, r.avgTurnaround, r.avgResponse, r.p50, r.p95, r.p99, r.maxWait, r.contextSwitches,
+                    r.migrations, r.ms);
+    }
+    if (json)
+        fprintf(out, "]\n");
+    bool ok = !ferror(out);
+    if (out != stdout)
+        fclose(out);
+    else
+        fflush(out);
+    return ok;
+}
+
+// benchmarkRoundRobin Function: Round Robin with fast forward against one loop iteration per slice
+// - Tiny quanta and huge bursts, arrivals spread over the first quarter of the work so the queue keeps changing
+// - Both must produce the same schedule; the last rows are too long to run slice by slice
+void benchmarkRoundRobin() {
+    struct Config { int n; int maxBurst; int quantum; bool reference; };
+    vector<Config> configs = {{10, 10000000, 1, true}, {100, 1000000, 1, true}, {1000, 100000, 2, true},
+                              {100000, 1000, 1, true}, {1000, 1000000000, 1, false}, {10000, 100000000, 1, false}};
+    cout << "Processes\tMax burst\tQuantum\tSlices\t\tPer slice ms\tFast forward ms\tSpeedup" << endl;
+    for (const Config& cfg : configs) {
+        mt19937 rng(cfg.n);
+        vector<Process> procs(cfg.n);
+        long long slices = 0, spread = max(1LL, (long long)cfg.n * cfg.maxBurst / 4);
+        for (int i = 0; i < cfg.n; i++) {
+            procs[i].pid = i + 1;
+            procs[i].arrival = rng() % spread;
+            procs[i].burst = cfg.maxBurst / 2 + rng() % (cfg.maxBurst / 2 + 1);
+            procs[i].remaining = procs[i].burst;
+            procs[i].waiting = 0;
+            slices += (procs[i].burst + cfg.quantum - 1) / cfg.quantum;
+        }
+        vector<int> order = arrivalOrder(procs);
+
+        ScheduleStats fast, reference;
+        auto t0 = chrono::steady_clock::now();
+        simulateRoundRobin(procs, order, cfg.quantum, fast);
+        auto t1 = chrono::steady_clock::now();
+        if (cfg.reference)
+            simulateRoundRobin(procs, order, cfg.quantum, reference, false);
+        auto t2 = chrono::steady_clock::now();
+        double fastMs = chrono::duration<double, milli>(t1 - t0).count();
+        double referenceMs = chrono::duration<double, milli>(t2 - t1).count();
+
+        cout << cfg.n << "\t\t" << cfg.maxBurst << (cfg.maxBurst < 10000000 ? "\t\t" : "\t") << cfg.quantum << "\t" << slices
+             << (slices < 10000000 ? "\t\t" : "\t") << fixed << setprecision(2);
+        if (cfg.reference)
+            cout << referenceMs << "\t\t";
+        else
+            cout << "-\t\t";
+        cout << fastMs << "\t\t";
+        if (cfg.reference)
+            cout << referenceMs / max(fastMs, 0.001) << "x";
+        else
+            cout << "-";
+        if (cfg.reference && (fast.finish != reference.finish || fast.start != reference.start ||
+                              fast.contextSwitches != reference.contextSwitches))
+            cout << "\tMISMATCH";
+        cout << endl;
+    }
+}
+
+// parseIntList Helper Function: "1,2,4" -> {1, 2, 4}
+vector<int> parseIntList(const string& list) {
+    vector<int> values;
+    size_t pos = 0;
+    while (pos < list.size()) {
+        size_t comma = list.find(',', pos);
+        if (comma == string::npos)
+            comma = list.size();
+        if (comma > pos)
+            values.push_back(atoi(list.substr(pos, comma - pos).c_str()));
+        pos = comma + 1;
+    }
+    return values;
+}
+
 // Main Simulation Loop
-int main() {
+// - Usage: taskfive [--policies fcfs,sjf,rr,srtf,priority,mlfq,cfs|all] [--priorities] [--aging N]
+//                   [--mlfq-levels L] [--boost S] [--latency T] [--granularity G] [--metrics]
+//                   [--cpus N[,N...]] [--core-policy rr|fcfs] [--no-steal] [--affinity]
+//          taskfive (--trace FILE | --generate N [--seed S] [--rate R] [--pareto-alpha A] [--burst-min B]
+//                   [--burst-max B] [--write FILE]) [--quantum Q[,Q...]] [--threads T] [--tables]
+//                   [--csv FILE|-] [--json FILE|-] [policy and core options above]
+//          taskfive --bench-rr
+// - Without options it runs FCFS, SJF and Round Robin exactly as before
+// - --priorities also asks for a priority per process (smaller runs first, the nice value for CFS)
+// - --metrics prints the turnaround / response / percentile / context switch table; it is on whenever a
+//   policy beyond the original three is selected
+// - --cpus runs the multi-core simulation instead (add --policies to get the single CPU runs as well); a list of
+//   core counts prints one summary row per count
+// - --trace / --generate replace the prompts and run a sweep: every policy (all seven unless --policies says
+//   otherwise), every quantum for rr and mlfq, and every --cpus count for fcfs and rr, on --threads threads;
+//   per-process tables only with --tables, and the summary can also go to CSV / JSON
+int main(int argc, char* argv[]) {
+    vector<string> policies = {"fcfs", "sjf", "rr"};
+    bool askPriorities = false, metrics = false, policiesGiven = false;
+    PolicyOptions options;
+    bool singleCpu = true, coreRoundRobin = true;
+    vector<int> cpuCounts;
+    MultiCoreOptions multi;
+    string traceFile, writeFile, csvFile, jsonFile;
+    int generateCount = 0, burstMin = 1, burstMax = 100000;
+    unsigned int seed = 1;
+    double rate = 0.25, alpha = 1.5;   // mean burst about 3.6 at the defaults, so about 90% load
+    vector<int> quantums = {4};
+    int numThreads = max(1u, thread::hardware_concurrency());
+    bool tables = false;
+    for (int a = 1; a < argc; a++) {
+        string arg = argv[a];
+        if (arg == "--policies" && a + 1 < argc) {
+            string list = argv[++a];
+            if (list == "all")
+                list = "fcfs,sjf,rr,srtf,priority,mlfq,cfs";
+            policies.clear();
+            singleCpu = false;
+            policiesGiven = true;
+            size_t pos = 0;
+            while (pos <= list.size()) {
+                size_t comma = list.find(',', pos);
+                if (comma == string::npos)
+                    comma = list.size();
+                string name = list.substr(pos, comma - pos);
+                if (name == "fcfs" || name == "sjf" || name == "rr" || name == "srtf" || name == "priority" ||
+                    name == "mlfq" || name == "cfs") {
+                    policies.push_back(name);
+                    if (name != "fcfs" && name != "sjf" && name != "rr")
+                        metrics = true;
+                } else if (!name.empty()) {
+                    cerr << "Unknown policy: " << name << endl;
+                    return 1;
+                }
+                pos = comma + 1;
+            }
+        }
+        else if (arg == "--priorities") askPriorities = true;
+        else if (arg == "--metrics") metrics = true;
+        else if (arg == "--aging" && a + 1 < argc) options.agingInterval = max(0, atoi(argv[++a]));
+        else if (arg == "--mlfq-levels" && a + 1 < argc) options.mlfqLevels = max(1, min(30, atoi(argv[++a])));
+        else if (arg == "--boost" && a + 1 < argc) options.boostPeriod = max(0, atoi(argv[++a]));
+        else if (arg == "--latency" && a + 1 < argc) options.targetLatency = max(1, atoi(argv[++a]));
+        else if (arg == "--granularity" && a + 1 < argc) options.minGranularity = max(1, atoi(argv[++a]));
+        else if (arg == "--cpus" && a + 1 < argc) cpuCounts = parseIntList(argv[++a]);
+        else if (arg == "--core-policy" && a + 1 < argc) coreRoundRobin = string(argv[++a]) != "fcfs";
+        else if (arg == "--no-steal") multi.steal = false;
+        else if (arg == "--affinity") multi.affinity = true;
+        else if (arg == "--trace" && a + 1 < argc) traceFile = argv[++a];
+        else if (arg == "--generate" && a + 1 < argc) generateCount = max(1, atoi(argv[++a]));
+        else if (arg == "--seed" && a + 1 < argc) seed = strtoul(argv[++a], nullptr, 10);
+        else if (arg == "--rate" && a + 1 < argc && atof(argv[a + 1]) > 0) rate = atof(argv[++a]);
+        else if (arg == "--pareto-alpha" && a + 1 < argc && atof(argv[a + 1]) > 0) alpha = atof(argv[++a]);
+        else if (arg == "--burst-min" && a + 1 < argc) burstMin = max(1, atoi(argv[++a]));
+        else if (arg == "--burst-max" && a + 1 < argc) burstMax = max(1, atoi(argv[++a]));
+        else if (arg == "--write" && a + 1 < argc) writeFile = argv[++a];
+        else if (arg == "--quantum" && a + 1 < argc) quantums = parseIntList(argv[++a]);
+        else if (arg == "--threads" && a + 1 < argc && atoi(argv[a + 1]) > 0) numThreads = atoi(argv[++a]);
+        else if (arg == "--tables") tables = true;
+        else if (arg == "--csv" && a + 1 < argc) csvFile = argv[++a];
+        else if (arg == "--json" && a + 1 < argc) jsonFile = argv[++a];
+        else if (arg == "--bench-rr") {
+            benchmarkRoundRobin();
+            return 0;
+        }
+        else {
+            cerr << "Usage: " << argv[0] << " [--policies fcfs,sjf,rr,srtf,priority,mlfq,cfs|all] [--priorities]"
+                 << " [--aging N] [--mlfq-levels L] [--boost S] [--latency T] [--granularity G] [--metrics]"
+                 << " [--cpus N[,N...]] [--core-policy rr|fcfs] [--no-steal] [--affinity]" << endl;
+            cerr << "       " << argv[0] << " (--trace FILE | --generate N [--seed S] [--rate R] [--pareto-alpha A]"
+                 << " [--burst-min B] [--burst-max B] [--write FILE]) [--quantum Q[,Q...]] [--threads T] [--tables]"
+                 << " [--csv FILE|-] [--json FILE|-]" << endl;
+            cerr << "       " << argv[0] << " --bench-rr" << endl;
+            return 1;
+        }
+    }
+
+    // - Trace / generator mode: no prompts, one sweep over policies x quanta x core counts
+    if (!traceFile.empty() || generateCount > 0) {
+        vector<Process> processes;
+        auto t0 = chrono::steady_clock::now();
+        if (!traceFile.empty()) {
+            if (!readTraceMapped(traceFile, processes))
+                return 1;
+        } else {
+            generateWorkload(generateCount, seed, rate, alpha, burstMin, max(burstMin, burstMax), processes);
+            if (!writeFile.empty() && !writeTraceFile(writeFile, processes))
+                return 1;
+        }
+        double loadMs = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+
+        if (!policiesGiven)
+            policies = {"fcfs", "sjf", "rr", "srtf", "priority", "mlfq", "cfs"};
+        quantums.erase(remove_if(quantums.begin(), quantums.end(), [](int q) { return q <= 0; }), quantums.end());
+        if (quantums.empty())
+            quantums = {4};
+        if (cpuCounts.empty())
+            cpuCounts = {1};
+        vector<SweepJob> jobs;
+        for (const string& policy : policies) {
+            bool usesQuantum = policy == "rr" || policy == "mlfq";
+            bool multiCore = policy == "rr" || policy == "fcfs";
+            for (int q : usesQuantum ? quantums : vector<int>{quantums[0]})
+                for (int cpus : multiCore ? cpuCounts : vector<int>{1})
+                    jobs.push_back({policy, q, max(1, cpus)});
+        }
+
+        bool quiet = csvFile == "-" || jsonFile == "-";
+        if (!quiet)
+            cout << processes.size() << " processes " << (traceFile.empty() ? "generated" : "read") << " in " << fixed
+                 << setprecision(2) << loadMs << " ms; " << jobs.size() << " runs on "
+                 << max(1, min(numThreads, (int)jobs.size())) << " threads" << endl;
+        auto t1 = chrono::steady_clock::now();
+        vector<SweepResult> results = runSweep(processes, jobs, options, multi, tables, numThreads);
+        double sweepMs = chrono::duration<double, milli>(chrono::steady_clock::now() - t1).count();
+
+        if (tables)
+            for (const SweepResult& r : results)
+                cout << r.table;
+        if (!quiet) {
+            cout << "\n=== Sweep (" << fixed << setprecision(2) << sweepMs << " ms) ===" << endl;
+            printSweep(jobs, results);
+        }
+        if (!csvFile.empty() && !writeSweep(csvFile, false, jobs, results))
+            return 1;
+        if (!jsonFile.empty() && !writeSweep(jsonFile, true, jobs, results))
+            return 1;
+        return 0;
+    }
+
     int n;
     cout << "Enter number of processes: ";
     cin >> n;
@@ -174,6 +1398,10 @@ int main() {
         cin >> processes[i].arrival;
         cout << "P" << i + 1 << " burst time: ";
         cin >> processes[i].burst;
+        if (askPriorities) {
+            cout << "P" << i + 1 << " priority: ";
+            cin >> processes[i].priority;
+        }
         processes[i].remaining = processes[i].burst;
     }
 
@@ -181,14 +1409,51 @@ int main() {
     cout << "Enter time quantum for Round Robin: ";
     cin >> quantum;
 
-    double avgFCFS = fcfs(processes);
-    double avgSJF  = sjf(processes);
-    double avgRR   = roundRobin(processes, quantum);
+    if (!cpuCounts.empty()) {
+        vector<int> order = arrivalOrder(processes);
+        multi.quantum = coreRoundRobin ? quantum : 0;
+        bool rows = cpuCounts.size() > 1;
+        if (rows) {
+            cout << "\n--- " << (coreRoundRobin ? "Round Robin (quantum = " + to_string(quantum) + ")" : string("FCFS"))
+                 << " core count sweep ---" << endl;
+            cout << left << setw(8) << "CPUs" << setw(12) << "Avg wait" << setw(10) << "p50" << setw(10) << "p90"
+                 << setw(10) << "p99" << setw(12) << "Max" << setw(10) << "Util %" << setw(12) << "Migrations"
+                 << setw(10) << "Steals" << "ms" << endl;
+            cout << string(100, '-') << endl;
+        }
+        for (int k = 0; k < cpuCounts.size(); k++) {
+            multi.cpus = max(1, cpuCounts[k]);
+            MultiCoreStats stats;
+            auto t0 = chrono::steady_clock::now();
+            simulateMultiCore(processes, order, multi, stats);
+            double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+            printMultiCore(processes, multi, stats, ms, rows);
+        }
+        if (singleCpu)
+            return 0;
+    }
+
+    vector<string> labels;
+    vector<double> averages;
+    vector<ScheduleStats> results(policies.size());
+    for (int k = 0; k < policies.size(); k++) {
+        const string& name = policies[k];
+        ScheduleStats& stats = results[k];
+        if (name == "fcfs")          { labels.push_back("FCFS");        averages.push_back(fcfs(processes, stats)); }
+        else if (name == "sjf")      { labels.push_back("SJF");         averages.push_back(sjf(processes, stats)); }
+        else if (name == "rr")       { labels.push_back("Round Robin"); averages.push_back(roundRobin(processes, quantum, stats)); }
+        else if (name == "srtf")     { labels.push_back("SRTF");        averages.push_back(srtf(processes, stats)); }
+        else if (name == "priority") { labels.push_back("Priority");    averages.push_back(priorityAging(processes, options.agingInterval, stats)); }
+        else if (name == "mlfq")     { labels.push_back("MLFQ");        averages.push_back(mlfq(processes, options.mlfqLevels, quantum, options.boostPeriod, stats)); }
+        else                         { labels.push_back("CFS");         averages.push_back(cfs(processes, options.targetLatency, options.minGranularity, stats)); }
+    }
 
     cout << "\n=== Summary ===" << endl;
-    cout << "FCFS avg waiting time:        " << fixed << setprecision(2) << avgFCFS << endl;
-    cout << "SJF avg waiting time:         " << fixed << setprecision(2) << avgSJF  << endl;
-    cout << "Round Robin avg waiting time: " << fixed << setprecision(2) << avgRR   << endl;
+    for (int k = 0; k < labels.size(); k++)
+        cout << left << setw(30) << labels[k] + " avg waiting time:" << fixed << setprecision(2) << averages[k] << endl;
+
+    if (metrics)
+        printMetrics(processes, labels, results);
     
     return 0;
-}
\ No newline at end of file
+}
@@ -2,6 +2,28 @@
 #include <fstream>
 #include <vector>
 #include <string>
+#include <set>
+#include <algorithm>
+#include <climits>
+#include <chrono>
+#include <iomanip>
+#include <unordered_map>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cstdint>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_SIMD 1
+#endif
 
 using namespace std;
 
@@ -45,6 +67,83 @@ bool readInputFile(const string& filename,
     return true;
 }
 
+// readInputMapped Function: Reads the same input format as readInputFile from a memory mapping
+// - Hand-rolled integer parser instead of "ifstream >>", for systems with tens of thousands of processes
+// - Unlike readInputFile, a file that ends before all values are read is an error
+bool readInputMapped(const string& filename,
+                     int& numProcesses,
+                     int& numResources,
+                     vector<int>& E,
+                     vector<vector<int>>& C,
+                     vector<vector<int>>& R)
+{
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        cerr << "Error: Could not open file '" << filename << "'" << endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        cerr << "Error: '" << filename << "' is empty" << endl;
+        return false;
+    }
+    void* mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        cerr << "Error: Could not map file '" << filename << "'" << endl;
+        return false;
+    }
+    madvise(mapping, st.st_size, MADV_SEQUENTIAL);
+    const char* p = (const char*)mapping;
+    const char* end = p + st.st_size;
+
+    // - next: skips to the next integer and parses it; false at the end of the file
+    auto next = [&](int& value) {
+        while (p < end && !(*p >= '0' && *p <= '9') && *p != '-') {
+            p++;
+        }
+        if (p == end) {
+            return false;
+        }
+        bool negative = *p == '-';
+        if (negative) {
+            p++;
+        }
+        int v = 0;
+        while (p < end && *p >= '0' && *p <= '9') {
+            v = v * 10 + (*p++ - '0');
+        }
+        value = negative ? -v : v;
+        return true;
+    };
+
+    bool ok = next(numProcesses) && next(numResources) && numProcesses >= 0 && numResources >= 0;
+    if (ok) {
+        E.resize(numResources);
+        for (int j = 0; ok && j < numResources; j++) {
+            ok = next(E[j]);
+        }
+        C.assign(numProcesses, vector<int>(numResources));
+        for (int i = 0; ok && i < numProcesses; i++) {
+            for (int j = 0; ok && j < numResources; j++) {
+                ok = next(C[i][j]);
+            }
+        }
+        R.assign(numProcesses, vector<int>(numResources));
+        for (int i = 0; ok && i < numProcesses; i++) {
+            for (int j = 0; ok && j < numResources; j++) {
+                ok = next(R[i][j]);
+            }
+        }
+    }
+    munmap(mapping, st.st_size);
+    if (!ok) {
+        cerr << "Error: '" << filename << "' ends before all of E, C and R were read" << endl;
+    }
+    return ok;
+}
+
 // computeAvailable Function: Calculates the available resources vector "A" by subtracting the allocated
 // resources in matrix "C" from the total resources in vector "E"
 vector<int> computeAvailable(int numProcesses, int numResources,
@@ -116,6 +215,951 @@ vector<int> detectDeadlock(int numProcesses, int numResources,
     return deadlocked;
 }
 
+// printProcessList Function: Prints "P0, P3, ..." with at most "limit" names followed by the total
+void printProcessList(const vector<int>& processes, int limit, const string& separator = ", ")
+{
+    for (int i = 0; i < (int)processes.size() && i < limit; i++) {
+        cout << "P" << processes[i];
+        if (i < (int)processes.size() - 1) cout << separator;
+    }
+    if ((int)processes.size() > limit) {
+        cout << "... (" << processes.size() << " in total)";
+    }
+}
+
+// FlatMatrix Structure: rows x cols matrix stored row-major in one contiguous block
+struct FlatMatrix {
+    int rows = 0, cols = 0;
+    vector<int> data;
+
+    FlatMatrix() {}
+    FlatMatrix(int numRows, int numCols) : rows(numRows), cols(numCols), data((size_t)numRows * numCols, 0) {}
+
+    int* row(int i) { return &data[(size_t)i * cols]; }
+    const int* row(int i) const { return &data[(size_t)i * cols]; }
+    int& at(int i, int j) { return data[(size_t)i * cols + j]; }
+    int at(int i, int j) const { return data[(size_t)i * cols + j]; }
+};
+
+// flatten Function: copies a nested matrix into a FlatMatrix
+FlatMatrix flatten(const vector<vector<int>>& matrix, int numResources) {
+    FlatMatrix flat(matrix.size(), numResources);
+    for (int i = 0; i < flat.rows; i++) {
+        copy(matrix[i].begin(), matrix[i].begin() + numResources, flat.row(i));
+    }
+    return flat;
+}
+
+// AlignedRows Structure: rows x cols matrix in one 32-byte aligned block for the SIMD kernels
+// - Every row is padded with zeros to a multiple of 32 bytes ("stride" elements), so a row is a whole number of
+//   AVX2 registers and the kernels need no scalar tail; a zero request never exceeds a zero pad in "W"
+template <class T>
+struct AlignedRows {
+    int rows = 0, cols = 0, stride = 0;
+    T* data = nullptr;
+
+    AlignedRows(int numRows, int numCols) : rows(numRows), cols(numCols) {
+        int perVector = 32 / sizeof(T);
+        stride = max(perVector, (numCols + perVector - 1) / perVector * perVector);
+        size_t bytes = max((size_t)1, (size_t)numRows) * stride * sizeof(T);
+        data = (T*)aligned_alloc(32, bytes);
+        memset(data, 0, bytes);
+    }
+    ~AlignedRows() { free(data); }
+    AlignedRows(const AlignedRows&) = delete;
+    AlignedRows& operator=(const AlignedRows&) = delete;
+
+    T* row(int i) { return data + (size_t)i * stride; }
+    const T* row(int i) const { return data + (size_t)i * stride; }
+};
+
+// ResourceKernels Structure: the two inner loops of the reduction for one element type
+// - canRun:  true when request[j] <= work[j] for every j (the check of the canRun function)
+// - release: work[j] += allocation[j] (a finished process returning its resources)
+// - "n" is the padded row length, a multiple of 32 bytes
+template <class T>
+struct ResourceKernels {
+    bool (*canRun)(const T* request, const T* work, int n);
+    void (*release)(T* work, const T* allocation, int n);
+};
+
+// canRunScalar / releaseScalar Functions: one element at a time, the fallback kernels
+template <class T>
+bool canRunScalar(const T* request, const T* work, int n) {
+    for (int j = 0; j < n; j++) {
+        if (request[j] > work[j]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <class T>
+void releaseScalar(T* work, const T* allocation, int n) {
+    for (int j = 0; j < n; j++) {
+        work[j] += allocation[j];
+    }
+}
+
+#ifdef HAVE_X86_SIMD
+// SSE2 kernels: a signed compare "request > work" per lane, reduced with movemask; the early exit is checked
+// once per 32 bytes (two registers), like the AVX2 kernels
+bool canRunSSE2_32(const int32_t* request, const int32_t* work, int n) {
+    for (int j = 0; j < n; j += 8) {
+        __m128i over = _mm_or_si128(
+            _mm_cmpgt_epi32(_mm_load_si128((const __m128i*)(request + j)), _mm_load_si128((const __m128i*)(work + j))),
+            _mm_cmpgt_epi32(_mm_load_si128((const __m128i*)(request + j + 4)), _mm_load_si128((const __m128i*)(work + j + 4))));
+        if (_mm_movemask_epi8(over) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool canRunSSE2_16(const int16_t* request, const int16_t* work, int n) {
+    for (int j = 0; j < n; j += 16) {
+        __m128i over = _mm_or_si128(
+            _mm_cmpgt_epi16(_mm_load_si128((const __m128i*)(request + j)), _mm_load_si128((const __m128i*)(work + j))),
+            _mm_cmpgt_epi16(_mm_load_si128((const __m128i*)(request + j + 8)), _mm_load_si128((const __m128i*)(work + j + 8))));
+        if (_mm_movemask_epi8(over) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void releaseSSE2_32(int32_t* work, const int32_t* allocation, int n) {
+    for (int j = 0; j < n; j += 4) {
+        __m128i* w = (__m128i*)(work + j);
+        _mm_store_si128(w, _mm_add_epi32(_mm_load_si128(w), _mm_load_si128((const __m128i*)(allocation + j))));
+    }
+}
+
+void releaseSSE2_16(int16_t* work, const int16_t* allocation, int n) {
+    for (int j = 0; j < n; j += 8) {
+        __m128i* w = (__m128i*)(work + j);
+        _mm_store_si128(w, _mm_add_epi16(_mm_load_si128(w), _mm_load_si128((const __m128i*)(allocation + j))));
+    }
+}
+
+// AVX2 kernels: same as the SSE2 ones on 256-bit registers
+__attribute__((target("avx2")))
+bool canRunAVX2_32(const int32_t* request, const int32_t* work, int n) {
+    for (int j = 0; j < n; j += 8) {
+        __m256i over = _mm256_cmpgt_epi32(_mm256_load_si256((const __m256i*)(request + j)),
+                                          _mm256_load_si256((const __m256i*)(work + j)));
+        if (!_mm256_testz_si256(over, over)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+__attribute__((target("avx2")))
+bool canRunAVX2_16(const int16_t* request, const int16_t* work, int n) {
+    for (int j = 0; j < n; j += 16) {
+        __m256i over = _mm256_cmpgt_epi16(_mm256_load_si256((const __m256i*)(request + j)),
+                                          _mm256_load_si256((const __m256i*)(work + j)));
+        if (!_mm256_testz_si256(over, over)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+__attribute__((target("avx2")))
+void releaseAVX2_32(int32_t* work, const int32_t* allocation, int n) {
+    for (int j = 0; j < n; j += 8) {
+        __m256i* w = (__m256i*)(work + j);
+        _mm256_store_si256(w, _mm256_add_epi32(_mm256_load_si256(w), _mm256_load_si256((const __m256i*)(allocation + j))));
+    }
+}
+
+__attribute__((target("avx2")))
+void releaseAVX2_16(int16_t* work, const int16_t* allocation, int n) {
+    for (int j = 0; j < n; j += 16) {
+        __m256i* w = (__m256i*)(work + j);
+        _mm256_store_si256(w, _mm256_add_epi16(_mm256_load_si256(w), _mm256_load_si256((const __m256i*)(allocation + j))));
+    }
+}
+#endif
+
+// pickKernels Function: Chooses the kernels by name, "auto" picks the widest ones this CPU supports
+// - Returns false when the requested kernels are unknown or not supported here
+bool pickKernels(const string& name, ResourceKernels<int32_t>& k32, ResourceKernels<int16_t>& k16) {
+    k32 = {canRunScalar<int32_t>, releaseScalar<int32_t>};
+    k16 = {canRunScalar<int16_t>, releaseScalar<int16_t>};
+    if (name == "scalar") {
+        return true;
+    }
+#ifdef HAVE_X86_SIMD
+    bool avx2 = __builtin_cpu_supports("avx2");
+    if (name == "avx2" && !avx2) {
+        return false;
+    }
+    if (name == "avx2" || (name == "auto" && avx2)) {
+        k32 = {canRunAVX2_32, releaseAVX2_32};
+        k16 = {canRunAVX2_16, releaseAVX2_16};
+        return true;
+    }
+    if (name == "sse2" || name == "auto") {
+        k32 = {canRunSSE2_32, releaseSSE2_32};
+        k16 = {canRunSSE2_16, releaseSSE2_16};
+        return true;
+    }
+#else
+    if (name == "auto") {
+        return true;
+    }
+#endif
+    return false;
+}
+
+// fitsInt16 Function: true when every count of the system fits int16 storage
+// - W never exceeds E, so checking E, C and R is enough
+bool fitsInt16(const vector<int>& E, const vector<vector<int>>& C, const vector<vector<int>>& R) {
+    for (int e : E) {
+        if (e < 0 || e > INT16_MAX) return false;
+    }
+    for (int i = 0; i < (int)C.size(); i++) {
+        for (int j = 0; j < (int)E.size(); j++) {
+            if (C[i][j] < 0 || C[i][j] > INT16_MAX || R[i][j] < 0 || R[i][j] > INT16_MAX) return false;
+        }
+    }
+    return true;
+}
+
+// detectDeadlockSIMD Function: the detectDeadlock reduction on aligned, padded rows with the given kernels
+// - Same passes in the same order as detectDeadlock, so the result is identical; only the two inner loops change
+template <class T>
+vector<int> detectDeadlockSIMD(int numProcesses, int numResources,
+                               const vector<int>& E,
+                               const vector<vector<int>>& C,
+                               const vector<vector<int>>& R,
+                               const ResourceKernels<T>& kernels)
+{
+    AlignedRows<T> alloc(numProcesses, numResources), request(numProcesses, numResources), work(1, numResources);
+    for (int i = 0; i < numProcesses; i++) {
+        copy(C[i].begin(), C[i].begin() + numResources, alloc.row(i));
+        copy(R[i].begin(), R[i].begin() + numResources, request.row(i));
+    }
+    vector<int> A = computeAvailable(numProcesses, numResources, E, C);
+    copy(A.begin(), A.end(), work.row(0));
+
+    int n = work.stride;
+    vector<bool> finished(numProcesses, false);
+    bool progress = true;
+    while (progress) {
+        progress = false;
+        for (int i = 0; i < numProcesses; i++) {
+            if (!finished[i] && kernels.canRun(request.row(i), work.row(0), n)) {
+                kernels.release(work.row(0), alloc.row(i), n);
+                finished[i] = true;
+                progress = true;
+            }
+        }
+    }
+
+    vector<int> deadlocked;
+    for (int i = 0; i < numProcesses; i++) {
+        if (!finished[i]) {
+            deadlocked.push_back(i);
+        }
+    }
+    return deadlocked;
+}
+
+// DeadlockMonitor Structure: Incremental deadlock detector driven by allocate / request / release events
+// - Keeps the available vector "A" up to date instead of recomputing it from "E" and "C"
+// - For every process, "unsatisfied" counts the resource types whose request exceeds what is available;
+//   processes with a count of 0 are on the "ready" list, the others are blocked
+// - For every resource type, "waiters" orders the processes requesting it by request size, so a change of
+//   A[j] (or of W[j] during a check) only visits the processes whose request it crosses
+// - check() caches its answer: a deadlock-free system stays deadlock-free under releases and under requests
+//   that can be granted right away, so only blocking requests and allocations force a new reduction
+//   (and, while deadlocked, releases, which may break the deadlock)
+// - The reduction itself is a worklist: it starts from the ready processes, releases their allocations into
+//   "W" and wakes exactly the waiters whose request W now covers; it stops as soon as no process is blocked
+struct DeadlockMonitor {
+    int numProcesses, numResources;
+    vector<int> A;
+    FlatMatrix C, R;
+    vector<int> unsatisfied;
+    vector<set<pair<int, int>>> waiters;   // per resource: (request, process) for every non-zero request
+    vector<int> ready;                     // processes with unsatisfied == 0, in no particular order
+    vector<int> readyPos;                  // position in "ready", or -1
+    int blocked = 0;
+
+    bool dirty = true;
+    vector<int> deadlocked;
+
+    // - Scratch state of check(), stamped with the check number so nothing has to be cleared per check
+    vector<int> W, pending, pendingStamp, extra;
+    int stamp = 0;
+
+    long long checks = 0, cachedChecks = 0, processesReduced = 0;
+
+    DeadlockMonitor(const vector<int>& E, const vector<vector<int>>& allocation, const vector<vector<int>>& request)
+        : numProcesses(allocation.size()), numResources(E.size()),
+          A(computeAvailable(allocation.size(), E.size(), E, allocation)),
+          C(flatten(allocation, E.size())), R(numProcesses, numResources),
+          unsatisfied(numProcesses, 0), waiters(numResources), readyPos(numProcesses, -1),
+          pending(numProcesses, 0), pendingStamp(numProcesses, 0) {
+        for (int i = 0; i < numProcesses; i++) {
+            addReady(i);
+        }
+        for (int i = 0; i < numProcesses; i++) {
+            for (int j = 0; j < numResources; j++) {
+                setRequest(i, j, request[i][j]);
+            }
+        }
+    }
+
+    void addReady(int i) {
+        readyPos[i] = ready.size();
+        ready.push_back(i);
+    }
+
+    void removeReady(int i) {
+        int last = ready.back();
+        ready[readyPos[i]] = last;
+        readyPos[last] = readyPos[i];
+        ready.pop_back();
+        readyPos[i] = -1;
+    }
+
+    void addUnsatisfied(int i, int delta) {
+        if (unsatisfied[i] == 0) {
+            removeReady(i);
+            blocked++;
+        }
+        unsatisfied[i] += delta;
+        if (unsatisfied[i] == 0) {
+            addReady(i);
+            blocked--;
+        }
+    }
+
+    // setRequest Function: sets R[i][j], keeping "waiters" and the unsatisfied count of process i in step
+    void setRequest(int i, int j, int value) {
+        int old = R.at(i, j);
+        if (old == value) {
+            return;
+        }
+        if (old > 0) {
+            waiters[j].erase({old, i});
+        }
+        if (value > 0) {
+            waiters[j].insert({value, i});
+        }
+        R.at(i, j) = value;
+        int delta = (value > A[j]) - (old > A[j]);
+        if (delta != 0) {
+            addUnsatisfied(i, delta);
+        }
+    }
+
+    // setAvailable Function: sets A[j]; only the waiters with a request between the old and new value change state
+    void setAvailable(int j, int value) {
+        int old = A[j];
+        A[j] = value;
+        int low = min(old, value), high = max(old, value), delta = value < old ? 1 : -1;
+        for (auto it = waiters[j].upper_bound({low, INT_MAX}); it != waiters[j].end() && it->first <= high; ++it) {
+            addUnsatisfied(it->second, delta);
+        }
+    }
+
+    // request Function: process i asks for "amount" more units of resource j
+    void request(int i, int j, int amount) {
+        setRequest(i, j, R.at(i, j) + amount);
+        if (R.at(i, j) > A[j]) {
+            dirty = true;
+        }
+    }
+
+    // allocate Function: grants "amount" units of resource j to process i; fails if they are not available
+    // - The grant is taken from the outstanding request first
+    bool allocate(int i, int j, int amount) {
+        if (amount > A[j]) {
+            return false;
+        }
+        setAvailable(j, A[j] - amount);
+        C.at(i, j) += amount;
+        setRequest(i, j, max(0, R.at(i, j) - amount));
+        dirty = true;
+        return true;
+    }
+
+    // release Function: process i returns "amount" units of resource j; fails if it does not hold them
+    bool release(int i, int j, int amount) {
+        if (amount > C.at(i, j)) {
+            return false;
+        }
+        C.at(i, j) -= amount;
+        setAvailable(j, A[j] + amount);
+        if (!deadlocked.empty()) {
+            dirty = true;
+        }
+        return true;
+    }
+
+    // check Function: returns the deadlocked processes in increasing order (empty when there is no deadlock)
+    const vector<int>& check() {
+        checks++;
+        if (!dirty) {
+            cachedChecks++;
+            return deadlocked;
+        }
+        dirty = false;
+        deadlocked.clear();
+        if (blocked == 0) {
+            return deadlocked;
+        }
+
+        stamp++;
+        W = A;
+        extra.clear();
+        int remaining = blocked;
+        size_t numReady = ready.size();
+        for (size_t w = 0; w < numReady + extra.size() && remaining > 0; w++) {
+            int i = w < numReady ? ready[w] : extra[w - numReady];
+            processesReduced++;
+            const int* c = C.row(i);
+            for (int j = 0; j < numResources; j++) {
+                if (c[j] == 0) {
+                    continue;
+                }
+                int old = W[j];
+                W[j] += c[j];
+                for (auto it = waiters[j].upper_bound({old, INT_MAX}); it != waiters[j].end() && it->first <= W[j]; ++it) {
+                    int q = it->second;
+                    if (pendingStamp[q] != stamp) {
+                        pendingStamp[q] = stamp;
+                        pending[q] = unsatisfied[q];
+                    }
+                    if (--pending[q] == 0) {
+                        extra.push_back(q);
+                        remaining--;
+                    }
+                }
+            }
+        }
+
+        // - Blocked processes that the reduction never woke up are deadlocked
+        if (remaining > 0) {
+            for (int i = 0; i < numProcesses; i++) {
+                if (unsatisfied[i] > 0 && !(pendingStamp[i] == stamp && pending[i] == 0)) {
+                    deadlocked.push_back(i);
+                }
+            }
+        }
+        return deadlocked;
+    }
+};
+
+// WaitForGraph Structure: a single-instance system as a graph with an edge i -> k when process i requests a
+// resource that process k holds; stored as adjacency lists in one array (CSR)
+// - A request for a free resource adds no edge, it can always be granted
+// - A request for a resource the process holds itself is a self loop, one for more than the one instance
+//   can never be granted ("impossible")
+struct WaitForGraph {
+    int numProcesses = 0;
+    vector<int> offsets;    // edges of process i are targets[offsets[i] .. offsets[i + 1])
+    vector<int> targets;
+    vector<char> impossible;
+
+    // build Function: returns false when the system is not single-instance (E all ones, every unit held at most once)
+    bool build(const vector<int>& E, const vector<vector<int>>& C, const vector<vector<int>>& R) {
+        numProcesses = C.size();
+        int numResources = E.size();
+        for (int j = 0; j < numResources; j++) {
+            if (E[j] != 1) {
+                return false;
+            }
+        }
+        vector<int> holder(numResources, -1);
+        for (int i = 0; i < numProcesses; i++) {
+            for (int j = 0; j < numResources; j++) {
+                if (C[i][j] == 0) {
+                    continue;
+                }
+                if (C[i][j] != 1 || holder[j] != -1) {
+                    return false;
+                }
+                holder[j] = i;
+            }
+        }
+
+        offsets.assign(numProcesses + 1, 0);
+        targets.clear();
+        impossible.assign(numProcesses, 0);
+        for (int i = 0; i < numProcesses; i++) {
+            for (int j = 0; j < numResources; j++) {
+                if (R[i][j] > 1) {
+                    impossible[i] = 1;
+                } else if (R[i][j] == 1 && holder[j] != -1) {
+                    targets.push_back(holder[j]);
+                }
+            }
+            offsets[i + 1] = targets.size();
+        }
+        return true;
+    }
+};
+
+// WaitForResult Structure: deadlocked processes plus the cycles that cause them
+struct WaitForResult {
+    vector<int> deadlocked;            // increasing order, the same set detectDeadlock returns
+    vector<vector<int>> components;    // members of every strongly connected component that contains a cycle
+    vector<vector<int>> cycles;        // one concrete cycle per component, first process repeated at the end
+};
+
+// detectWaitForDeadlock Function: Tarjan's strongly connected components over the wait-for graph, O(V + E)
+// - A process is deadlocked when it is on a cycle, makes an impossible request, or waits (directly or not)
+//   on a deadlocked process; Tarjan finishes a component only after everything it can reach, so this is
+//   decided component by component as they come off the stack
+// - Iterative, so long wait chains cannot overflow the call stack
+WaitForResult detectWaitForDeadlock(const WaitForGraph& graph) {
+    int n = graph.numProcesses;
+    WaitForResult result;
+    vector<int> index(n, -1), low(n, 0), component(n, -1);
+    vector<char> onStack(n, 0), componentDeadlocked;
+    vector<int> stack, callStack, edgePos;
+    int nextIndex = 0;
+
+    for (int s = 0; s < n; s++) {
+        if (index[s] != -1) {
+            continue;
+        }
+        callStack.push_back(s);
+        edgePos.push_back(graph.offsets[s]);
+        index[s] = low[s] = nextIndex++;
+        stack.push_back(s);
+        onStack[s] = 1;
+
+        while (!callStack.empty()) {
+            int v = callStack.back();
+            int& e = edgePos.back();
+            if (e < graph.offsets[v + 1]) {
+                int w = graph.targets[e++];
+                if (index[w] == -1) {
+                    index[w] = low[w] = nextIndex++;
+                    stack.push_back(w);
+                    onStack[w] = 1;
+                    callStack.push_back(w);
+                    edgePos.push_back(graph.offsets[w]);
+                } else if (onStack[w]) {
+                    low[v] = min(low[v], index[w]);
+                }
+                continue;
+            }
+
+            callStack.pop_back();
+            edgePos.pop_back();
+            if (!callStack.empty()) {
+                low[callStack.back()] = min(low[callStack.back()], low[v]);
+            }
+            if (low[v] != index[v]) {
+                continue;
+            }
+
+            // - v is the root of a component: pop it and decide whether it is deadlocked
+            int id = componentDeadlocked.size();
+            vector<int> members;
+            int w;
+            do {
+                w = stack.back();
+                stack.pop_back();
+                onStack[w] = 0;
+                component[w] = id;
+                members.push_back(w);
+            } while (w != v);
+
+            bool cyclic = members.size() > 1;
+            bool dead = false;
+            for (int m : members) {
+                dead = dead || graph.impossible[m];
+                for (int k = graph.offsets[m]; k < graph.offsets[m + 1]; k++) {
+                    int t = graph.targets[k];
+                    cyclic = cyclic || t == m;
+                    dead = dead || (component[t] != id && componentDeadlocked[component[t]]);
+                }
+            }
+            componentDeadlocked.push_back(dead || cyclic);
+            if (!cyclic) {
+                continue;
+            }
+
+            // - Walk edges inside the component until a process repeats; the walk from that process on is a cycle
+            sort(members.begin(), members.end());
+            vector<int> path;
+            int u = members[0];
+            unordered_map<int, int> position;
+            while (position.find(u) == position.end()) {
+                position[u] = path.size();
+                path.push_back(u);
+                for (int k = graph.offsets[u]; k < graph.offsets[u + 1]; k++) {
+                    if (component[graph.targets[k]] == id) {
+                        u = graph.targets[k];
+                        break;
+                    }
+                }
+            }
+            vector<int> cycle(path.begin() + position[u], path.end());
+            cycle.push_back(u);
+            result.components.push_back(members);
+            result.cycles.push_back(cycle);
+        }
+    }
+
+    for (int i = 0; i < n; i++) {
+        if (componentDeadlocked[component[i]]) {
+            result.deadlocked.push_back(i);
+        }
+    }
+    return result;
+}
+
+// BankerState Structure: state for deadlock avoidance - available vector, allocations, maximum claims and the
+// remaining need (Max - C) of every process
+// - "safeSequence" is the last sequence known to be safe for the current state; granting a request only lowers
+//   A and the requester's need, so the old sequence is usually still safe and is tried before a new search
+struct BankerState {
+    int numProcesses = 0, numResources = 0;
+    vector<int> A;
+    vector<vector<int>> C, Max, Need;
+    vector<int> safeSequence;
+};
+
+// findSafeSequence Function: Banker's safety algorithm; fills "sequence" and returns true when all processes can finish
+// - Worklist search instead of rescanning every process per pass: for every resource the processes are sorted by
+//   need and a pointer marks how far W already covers; when a finished process adds to W[j] only the pointer moves,
+//   and a process becomes runnable when its count of uncovered resources reaches 0 - O(P·R·log P) in total
+bool findSafeSequence(const BankerState& s, vector<int>& sequence) {
+    int numProcesses = s.numProcesses, numResources = s.numResources;
+    vector<int> W = s.A;
+    vector<int> uncovered(numProcesses, 0);
+    vector<vector<int>> order(numResources);
+    vector<int> next(numResources, 0);
+    for (int j = 0; j < numResources; j++) {
+        order[j].resize(numProcesses);
+        for (int i = 0; i < numProcesses; i++) {
+            order[j][i] = i;
+        }
+        sort(order[j].begin(), order[j].end(), [&](int a, int b) { return s.Need[a][j] < s.Need[b][j]; });
+        while (next[j] < numProcesses && s.Need[order[j][next[j]]][j] <= W[j]) {
+            next[j]++;
+        }
+        for (int k = next[j]; k < numProcesses; k++) {
+            uncovered[order[j][k]]++;
+        }
+    }
+
+    sequence.clear();
+    for (int i = 0; i < numProcesses; i++) {
+        if (uncovered[i] == 0) {
+            sequence.push_back(i);
+        }
+    }
+    for (size_t k = 0; k < sequence.size(); k++) {
+        int i = sequence[k];
+        for (int j = 0; j < numResources; j++) {
+            if (s.C[i][j] == 0) {
+                continue;
+            }
+            W[j] += s.C[i][j];
+            while (next[j] < numProcesses && s.Need[order[j][next[j]]][j] <= W[j]) {
+                if (--uncovered[order[j][next[j]]] == 0) {
+                    sequence.push_back(order[j][next[j]]);
+                }
+                next[j]++;
+            }
+        }
+    }
+    return (int)sequence.size() == numProcesses;
+}
+
+// revalidateSequence Function: checks a previously safe sequence against the current state with canRun, O(P·R)
+bool revalidateSequence(const BankerState& s, const vector<int>& sequence) {
+    if ((int)sequence.size() != s.numProcesses) {
+        return false;
+    }
+    vector<int> W = s.A;
+    for (int i : sequence) {
+        if (!canRun(i, s.numResources, s.Need, W)) {
+            return false;
+        }
+        for (int j = 0; j < s.numResources; j++) {
+            W[j] += s.C[i][j];
+        }
+    }
+    return true;
+}
+
+// Admission Enumeration: outcome of a resource request under the Banker's algorithm
+enum Admission { GRANTED, UNSAFE, MUST_WAIT, EXCEEDS_CLAIM };
+
+const char* admissionName(Admission a) {
+    switch (a) {
+        case GRANTED: return "GRANTED";
+        case UNSAFE: return "DENIED (unsafe)";
+        case MUST_WAIT: return "WAIT (not available)";
+        default: return "REJECTED (exceeds claim)";
+    }
+}
+
+// evaluateRequest Function: tentatively grants "request" to process p and keeps it only if the state stays safe
+// - With "commit" false the state is always restored, which is how the batch evaluation asks "what if"
+// - "usedCache" tells whether the cached safe sequence was enough or a new search was needed
+Admission evaluateRequest(BankerState& s, int p, const vector<int>& request, bool commit, bool& usedCache) {
+    usedCache = false;
+    for (int j = 0; j < s.numResources; j++) {
+        if (request[j] > s.Need[p][j]) {
+            return EXCEEDS_CLAIM;
+        }
+    }
+    for (int j = 0; j < s.numResources; j++) {
+        if (request[j] > s.A[j]) {
+            return MUST_WAIT;
+        }
+    }
+
+    for (int j = 0; j < s.numResources; j++) {
+        s.A[j] -= request[j];
+        s.C[p][j] += request[j];
+        s.Need[p][j] -= request[j];
+    }
+    bool safe;
+    vector<int> sequence;
+    if (revalidateSequence(s, s.safeSequence)) {
+        usedCache = true;
+        safe = true;
+    } else {
+        safe = findSafeSequence(s, sequence);
+    }
+
+    if (safe && commit) {
+        if (!usedCache) {
+            s.safeSequence = sequence;
+        }
+        return GRANTED;
+    }
+    for (int j = 0; j < s.numResources; j++) {
+        s.A[j] += request[j];
+        s.C[p][j] -= request[j];
+        s.Need[p][j] += request[j];
+    }
+    return safe ? GRANTED : UNSAFE;
+}
+
+// readClaimsFile Function: reads the maximum claim matrix (one row per process) followed by the request queue,
+// one request per line: the process index and one amount per resource type
+bool readClaimsFile(const string& filename, BankerState& s,
+                    vector<int>& requestProcess, vector<vector<int>>& requests)
+{
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Error: Could not open file '" << filename << "'" << endl;
+        return false;
+    }
+
+    s.Max.assign(s.numProcesses, vector<int>(s.numResources));
+    s.Need.assign(s.numProcesses, vector<int>(s.numResources));
+    for (int i = 0; i < s.numProcesses; i++) {
+        for (int j = 0; j < s.numResources; j++) {
+            if (!(file >> s.Max[i][j])) {
+                cerr << "Error: claims file ends inside the maximum claim matrix" << endl;
+                return false;
+            }
+            s.Need[i][j] = s.Max[i][j] - s.C[i][j];
+            if (s.Need[i][j] < 0) {
+                cerr << "Error: P" << i << " holds more of resource " << j << " than it claims" << endl;
+                return false;
+            }
+        }
+    }
+
+    int p;
+    while (file >> p) {
+        vector<int> request(s.numResources);
+        for (int j = 0; j < s.numResources; j++) {
+            file >> request[j];
+        }
+        if (!file || p < 0 || p >= s.numProcesses) {
+            cerr << "Error: bad request " << requests.size() + 1 << " in claims file" << endl;
+            return false;
+        }
+        requestProcess.push_back(p);
+        requests.push_back(request);
+    }
+    return true;
+}
+
+// formatRequest Function: "P<p> (r0 r1 ...)"
+string formatRequest(int p, const vector<int>& request) {
+    string text = "P" + to_string(p) + " (";
+    for (int j = 0; j < (int)request.size(); j++) {
+        text += to_string(request[j]);
+        if (j < (int)request.size() - 1) text += " ";
+    }
+    return text + ")";
+}
+
+// runBanker Function: admits the request queue in order and reports each decision and its latency
+// - With "batch", every request is first evaluated on its own against the initial state on "numThreads" threads
+//   (each worker copies the state once and restores it after every candidate)
+bool runBanker(const string& claimsFile, int numProcesses, int numResources, const vector<int>& E,
+               const vector<vector<int>>& C, bool batch, int numThreads, int listLimit)
+{
+    BankerState s;
+    s.numProcesses = numProcesses;
+    s.numResources = numResources;
+    s.A = computeAvailable(numProcesses, numResources, E, C);
+    s.C = C;
+    vector<int> requestProcess;
+    vector<vector<int>> requests;
+    if (!readClaimsFile(claimsFile, s, requestProcess, requests)) {
+        return false;
+    }
+
+    cout << "\n--- Banker's Algorithm ---" << endl;
+    bool safe = findSafeSequence(s, s.safeSequence);
+    if (safe) {
+        cout << "Initial state is SAFE. Safe sequence: ";
+        printProcessList(s.safeSequence, listLimit);
+        cout << endl;
+    } else {
+        cout << "Initial state is UNSAFE; no request will be granted." << endl;
+        s.safeSequence.clear();
+    }
+
+    int n = requests.size();
+    if (batch && n > 0) {
+        vector<Admission> whatIf(n);
+        atomic<int> nextRequest(0);
+        auto start = chrono::steady_clock::now();
+        vector<thread> workers;
+        for (int w = 0; w < max(1, min(numThreads, n)); w++) {
+            workers.push_back(thread([&] {
+                BankerState local = s;
+                bool usedCache;
+                int r;
+                while ((r = nextRequest++) < n) {
+                    whatIf[r] = safe ? evaluateRequest(local, requestProcess[r], requests[r], false, usedCache) : UNSAFE;
+                }
+            }));
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        double ms = chrono::duration<double>(chrono::steady_clock::now() - start).count() * 1000;
+        cout << "\nEach request on its own against the initial state (" << workers.size() << " threads, "
+             << fixed << setprecision(3) << ms << " ms):" << endl;
+        for (int r = 0; r < n && r < listLimit; r++) {
+            cout << "  Request " << r + 1 << ": " << formatRequest(requestProcess[r], requests[r]) << " -> "
+                 << (whatIf[r] == GRANTED ? "safe" : admissionName(whatIf[r])) << endl;
+        }
+        if (n > listLimit) {
+            cout << "  ... (" << n << " requests in total)" << endl;
+        }
+    }
+
+    cout << "\nAdmitting the queue in order:" << endl;
+    vector<double> latency;
+    int granted = 0, fromCache = 0;
+    for (int r = 0; r < n; r++) {
+        bool usedCache = false;
+        auto start = chrono::steady_clock::now();
+        Admission result = safe ? evaluateRequest(s, requestProcess[r], requests[r], true, usedCache) : UNSAFE;
+        latency.push_back(chrono::duration<double>(chrono::steady_clock::now() - start).count() * 1e6);
+        granted += result == GRANTED;
+        fromCache += usedCache;
+        if (r < listLimit) {
+            cout << "  Request " << r + 1 << ": " << formatRequest(requestProcess[r], requests[r]) << " -> "
+                 << admissionName(result) << (usedCache ? " [cached sequence]" : "") << endl;
+        }
+    }
+    if (n > listLimit) {
+        cout << "  ... (" << n << " requests in total)" << endl;
+    }
+
+    if (!latency.empty()) {
+        vector<double> sorted = latency;
+        sort(sorted.begin(), sorted.end());
+        double total = 0;
+        for (double l : sorted) {
+            total += l;
+        }
+        auto percentile = [&](double q) { return sorted[min(sorted.size() - 1, (size_t)(q * sorted.size()))]; };
+        cout << "\nRequests: " << n << ", granted: " << granted << ", decided from the cached sequence: " << fromCache << endl;
+        cout << "Admission latency (us): min " << fixed << setprecision(2) << sorted.front()
+             << ", avg " << total / n << ", p50 " << percentile(0.5) << ", p99 " << percentile(0.99)
+             << ", max " << sorted.back() << endl;
+    }
+    return true;
+}
+
+// replayEvents Function: applies an event file to the monitor, printing the result of every "check"
+// - One event per line: "allocate P J K", "request P J K", "release P J K" or "check" (indices start at 0)
+bool replayEvents(const string& filename, DeadlockMonitor& monitor) {
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Error: Could not open file '" << filename << "'" << endl;
+        return false;
+    }
+
+    string event;
+    long long lineNumber = 0, rejected = 0;
+    double checkSeconds = 0;
+    while (file >> event) {
+        lineNumber++;
+        if (event == "check") {
+            auto start = chrono::steady_clock::now();
+            const vector<int>& deadlocked = monitor.check();
+            checkSeconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            cout << "Check " << monitor.checks << ": ";
+            if (deadlocked.empty()) {
+                cout << "no deadlock" << endl;
+            } else {
+                cout << "DEADLOCK ";
+                for (int i = 0; i < (int)deadlocked.size(); i++) {
+                    cout << "P" << deadlocked[i];
+                    if (i < (int)deadlocked.size() - 1) cout << ", ";
+                }
+                cout << endl;
+            }
+            continue;
+        }
+
+        int i, j, amount;
+        if (!(file >> i >> j >> amount) || i < 0 || i >= monitor.numProcesses || j < 0 ||
+            j >= monitor.numResources || amount < 0) {
+            cerr << "Error: bad event on line " << lineNumber << endl;
+            return false;
+        }
+        bool ok = true;
+        if (event == "allocate" || event == "alloc") {
+            ok = monitor.allocate(i, j, amount);
+        } else if (event == "request") {
+            monitor.request(i, j, amount);
+        } else if (event == "release") {
+            ok = monitor.release(i, j, amount);
+        } else {
+            cerr << "Error: unknown event '" << event << "' on line " << lineNumber << endl;
+            return false;
+        }
+        if (!ok) {
+            rejected++;
+        }
+    }
+
+    cout << "\nEvents: " << lineNumber << " (" << rejected << " rejected)" << endl;
+    cout << "Checks: " << monitor.checks << " (" << monitor.cachedChecks << " answered from cache), "
+         << monitor.processesReduced << " process reductions, "
+         << fixed << setprecision(3) << checkSeconds * 1e6 / max(1LL, monitor.checks) << " us per check" << endl;
+    return true;
+}
+
 // printMatrix Function: Prints a matrix with a label
 void printMatrix(const string& label, const vector<vector<int>>& matrix,
                  int rows, int cols)
@@ -142,33 +1186,439 @@ void printVector(const string& label, const vector<int>& vec)
     cout << endl;
 }
 
+// generateSystem Function: builds a random system whose answer is known, reproducible from "seed"
+// - Every process holds and requests a few resource types (sparse rows, like real systems)
+// - Requests are drawn along a random completion order, each no larger than what is free once the processes
+//   before it have finished, so without "deadlockSize" the system always reduces completely
+// - With "deadlockSize" K the last K processes of that order form a cycle: each holds one unit of a resource
+//   and asks for one unit more of the next one's resource than can ever be free, so exactly they are deadlocked
+void generateSystem(int numProcesses, int numResources, unsigned int seed, int deadlockSize,
+                    vector<int>& E, vector<vector<int>>& C, vector<vector<int>>& R)
+{
+    mt19937 rng(seed);
+    const int perRow = min(numResources, 4);
+    E.assign(numResources, 0);
+    for (int j = 0; j < numResources; j++) {
+        E[j] = 2 + (int)(8LL * numProcesses / numResources) + rng() % 4;
+    }
+    C.assign(numProcesses, vector<int>(numResources, 0));
+    R.assign(numProcesses, vector<int>(numResources, 0));
+
+    vector<int> order(numProcesses);
+    for (int i = 0; i < numProcesses; i++) {
+        order[i] = i;
+    }
+    shuffle(order.begin(), order.end(), rng);
+    deadlockSize = min(deadlockSize, numProcesses);
+    int numSafe = numProcesses - (deadlockSize >= 2 ? deadlockSize : 0);
+
+    // - Allocations: first one unit for every cycle member, then a few random units per process
+    // - A resource drawn by more cycle members than it has units gets more units, so no count goes negative
+    vector<int> A = E;
+    vector<int> cycleResource;
+    for (int k = numSafe; k < numProcesses; k++) {
+        int j = rng() % numResources;
+        if (A[j] == 0) {
+            E[j]++;
+            A[j]++;
+        }
+        C[order[k]][j]++;
+        A[j]--;
+        cycleResource.push_back(j);
+    }
+    for (int i = 0; i < numProcesses; i++) {
+        for (int k = 0; k < perRow; k++) {
+            int j = rng() % numResources;
+            int units = min(A[j], 1 + (int)(rng() % 2));
+            C[i][j] += units;
+            A[j] -= units;
+        }
+    }
+
+    // - Requests of the completing processes, along the order
+    vector<int> W = A;
+    for (int k = 0; k < numSafe; k++) {
+        int i = order[k];
+        for (int r = 0; r < perRow; r++) {
+            int j = rng() % numResources;
+            R[i][j] = min(W[j], 1 + (int)(rng() % 3));
+        }
+        for (int j = 0; j < numResources; j++) {
+            W[j] += C[i][j];
+        }
+    }
+
+    // - The cycle: W now holds everything except the cycle members' allocations
+    for (int k = numSafe; k < numProcesses; k++) {
+        int nextResource = cycleResource[(k - numSafe + 1) % (numProcesses - numSafe)];
+        R[order[k]][nextResource] = W[nextResource] + 1;
+    }
+}
+
+// writeInputFile Function: Writes a system in the format readInputFile reads
+bool writeInputFile(const string& filename, const vector<int>& E,
+                    const vector<vector<int>>& C, const vector<vector<int>>& R)
+{
+    FILE* out = fopen(filename.c_str(), "w");
+    if (out == nullptr) {
+        cerr << "Error: Could not create file '" << filename << "'" << endl;
+        return false;
+    }
+    string line;
+    auto writeRow = [&](const vector<int>& row) {
+        line.clear();
+        for (int j = 0; j < (int)row.size(); j++) {
+            line += to_string(row[j]);
+            line += j < (int)row.size() - 1 ? ' ' : '\n';
+        }
+        fwrite(line.data(), 1, line.size(), out);
+    };
+    fprintf(out, "%d %d\n", (int)C.size(), (int)E.size());
+    writeRow(E);
+    for (const auto& row : C) {
+        writeRow(row);
+    }
+    for (const auto& row : R) {
+        writeRow(row);
+    }
+    bool ok = !ferror(out);
+    fclose(out);
+    return ok;
+}
+
+// benchmarkWaitFor Function: times the matrix reductions against the wait-for graph on large sparse
+// single-instance systems (one resource per process, about one request per process)
+// - "acyclic" systems only wait on higher numbered processes and never deadlock; "random" ones usually do
+void benchmarkWaitFor() {
+    cout << "Processes\tSystem\t\tdetectDeadlock\tDeadlockMonitor\tGraph build\tTarjan SCC\tDeadlocked\tCycles" << endl;
+    cout << "\t\t\t\t(ms)\t\t(ms)\t\t(ms)\t\t(ms)" << endl;
+    unsigned int seed = 12345;
+    auto nextRandom = [&]() {
+        seed = seed * 1103515245u + 12345u;
+        return (seed >> 8) & 0xffffff;
+    };
+    for (int n : {1000, 2000, 4000}) {
+        for (int acyclic = 1; acyclic >= 0; acyclic--) {
+            vector<int> E(n, 1);
+            vector<vector<int>> C(n, vector<int>(n, 0)), R(n, vector<int>(n, 0));
+            for (int i = 0; i < n; i++) {
+                C[i][i] = 1;
+                if (nextRandom() % 4 != 0) {
+                    int j = acyclic ? (i + 1 < n ? i + 1 + nextRandom() % (n - i - 1) : -1) : nextRandom() % n;
+                    if (j >= 0 && j != i) {
+                        R[i][j] = 1;
+                    }
+                }
+            }
+
+            auto t0 = chrono::steady_clock::now();
+            vector<int> reference = detectDeadlock(n, n, E, C, R);
+            auto t1 = chrono::steady_clock::now();
+            DeadlockMonitor monitor(E, C, R);
+            vector<int> incremental = monitor.check();
+            auto t2 = chrono::steady_clock::now();
+            WaitForGraph graph;
+            graph.build(E, C, R);
+            auto t3 = chrono::steady_clock::now();
+            WaitForResult result = detectWaitForDeadlock(graph);
+            auto t4 = chrono::steady_clock::now();
+
+            auto ms = [](chrono::steady_clock::time_point a, chrono::steady_clock::time_point b) {
+                return chrono::duration<double>(b - a).count() * 1000;
+            };
+            cout << n << "\t\t" << (acyclic ? "acyclic" : "random") << "\t\t" << fixed << setprecision(2)
+                 << ms(t0, t1) << "\t\t" << ms(t1, t2) << "\t\t" << ms(t2, t3) << "\t\t" << ms(t3, t4) << "\t\t"
+                 << result.deadlocked.size() << "\t\t" << result.cycles.size();
+            if (reference != incremental || reference != result.deadlocked) {
+                cout << "\tMISMATCH";
+            }
+            cout << endl;
+        }
+    }
+}
+
+// benchmarkDetection Function: detection time against the number of processes P and resource types R
+// - For every size a deadlock-free and a deadlocked system come from generateSystem with a fixed seed
+// - The original detectDeadlock is O(P·P·R) in the worst case (one pass per finished process), so it only runs
+//   up to "referenceLimit" processes; generated systems mostly finish in a few passes, adversarial ones do not
+void benchmarkDetection(int referenceLimit) {
+    cout << "P\tR\tSystem\t\tdetectDeadlock\tMonitor build\tMonitor check\tDeadlocked" << endl;
+    cout << "\t\t\t\t(ms)\t\t(ms)\t\t(ms)" << endl;
+    auto ms = [](chrono::steady_clock::time_point a, chrono::steady_clock::time_point b) {
+        return chrono::duration<double>(b - a).count() * 1000;
+    };
+    for (int numProcesses : {1000, 4000, 16000, 50000}) {
+        for (int numResources : {16, 128, 500}) {
+            for (int deadlockSize : {0, 8}) {
+                vector<int> E;
+                vector<vector<int>> C, R;
+                generateSystem(numProcesses, numResources, 42, deadlockSize, E, C, R);
+
+                auto t0 = chrono::steady_clock::now();
+                vector<int> reference;
+                bool runReference = numProcesses <= referenceLimit;
+                if (runReference) {
+                    reference = detectDeadlock(numProcesses, numResources, E, C, R);
+                }
+                auto t1 = chrono::steady_clock::now();
+                DeadlockMonitor monitor(E, C, R);
+                auto t2 = chrono::steady_clock::now();
+                vector<int> deadlocked = monitor.check();
+                auto t3 = chrono::steady_clock::now();
+
+                cout << numProcesses << "\t" << numResources << "\t" << (deadlockSize ? "deadlocked\t" : "safe\t\t")
+                     << fixed << setprecision(2);
+                if (runReference) {
+                    cout << ms(t0, t1) << "\t\t";
+                } else {
+                    cout << "-\t\t";
+                }
+                cout << ms(t1, t2) << "\t\t" << ms(t2, t3) << "\t\t" << deadlocked.size();
+                if ((runReference && reference != deadlocked) || (int)deadlocked.size() != deadlockSize) {
+                    cout << "\tMISMATCH";
+                }
+                cout << endl;
+            }
+        }
+    }
+}
+
+// benchmarkKernels Function: microbenchmark of the canRun and release kernels against the original loops
+// - Every request fits, so canRun always scans whole rows (its worst case); about 256K counts per matrix keep the
+//   rows in cache, so the numbers show the kernels rather than memory bandwidth
+// - Times are nanoseconds per row; the speedup is against the original canRun on vector<vector<int>>
+void benchmarkKernels() {
+    ResourceKernels<int32_t> scalar32, sse32, avx32;
+    ResourceKernels<int16_t> scalar16, sse16, avx16;
+    pickKernels("scalar", scalar32, scalar16);
+    bool haveSSE2 = pickKernels("sse2", sse32, sse16);
+    bool haveAVX2 = pickKernels("avx2", avx32, avx16);
+
+    mt19937 rng(7);
+    auto ns = [](chrono::steady_clock::time_point a, chrono::steady_clock::time_point b, long long rows) {
+        return chrono::duration<double>(b - a).count() * 1e9 / rows;
+    };
+
+    for (int numResources : {16, 64, 256, 1024}) {
+        int numRows = (1 << 18) / numResources;
+        int reps = 200;
+        vector<vector<int>> R(numRows, vector<int>(numResources)), C(numRows, vector<int>(numResources));
+        vector<int> W(numResources, 100);
+        AlignedRows<int32_t> R32(numRows, numResources), C32(numRows, numResources), W32(1, numResources);
+        AlignedRows<int16_t> R16(numRows, numResources), C16(numRows, numResources), W16(1, numResources);
+        for (int i = 0; i < numRows; i++) {
+            for (int j = 0; j < numResources; j++) {
+                R[i][j] = R32.row(i)[j] = R16.row(i)[j] = rng() % 101;
+                C[i][j] = C32.row(i)[j] = C16.row(i)[j] = rng() % 2;
+            }
+        }
+
+        cout << "\nR = " << numResources << " (" << numRows << " rows x " << reps << " repetitions, ns per row)" << endl;
+        cout << "Kernel\t\tcanRun\t\tspeedup\t\trelease\t\tspeedup" << endl;
+
+        long long total = (long long)numRows * reps;
+        long long passed = 0;
+        auto t0 = chrono::steady_clock::now();
+        for (int r = 0; r < reps; r++) {
+            for (int i = 0; i < numRows; i++) {
+                passed += canRun(i, numResources, R, W);
+            }
+        }
+        auto t1 = chrono::steady_clock::now();
+        for (int r = 0; r < reps; r++) {
+            for (int i = 0; i < numRows; i++) {
+                for (int j = 0; j < numResources; j++) {
+                    W[j] += C[i][j];
+                }
+            }
+        }
+        auto t2 = chrono::steady_clock::now();
+        double baseCheck = ns(t0, t1, total), baseRelease = ns(t1, t2, total);
+        cout << "original\t" << fixed << setprecision(2) << baseCheck << "\t\t1.00\t\t" << baseRelease << "\t\t1.00" << endl;
+
+        auto run = [&](const string& name, auto& kernels, auto& Rm, auto& Cm, auto& Wm) {
+            int n = Wm.stride;
+            fill(Wm.row(0), Wm.row(0) + numResources, 100);
+            auto s0 = chrono::steady_clock::now();
+            for (int r = 0; r < reps; r++) {
+                for (int i = 0; i < numRows; i++) {
+                    passed += kernels.canRun(Rm.row(i), Wm.row(0), n);
+                }
+            }
+            auto s1 = chrono::steady_clock::now();
+            for (int r = 0; r < reps; r++) {
+                for (int i = 0; i < numRows; i++) {
+                    kernels.release(Wm.row(0), Cm.row(i), n);
+                }
+            }
+            auto s2 = chrono::steady_clock::now();
+            double check = ns(s0, s1, total), release = ns(s1, s2, total);
+            cout << name << "\t" << check << "\t\t" << baseCheck / check << "\t\t" << release << "\t\t" << baseRelease / release << endl;
+        };
+        run("scalar int32", scalar32, R32, C32, W32);
+        run("scalar int16", scalar16, R16, C16, W16);
+        if (haveSSE2) {
+            run("sse2 int32", sse32, R32, C32, W32);
+            run("sse2 int16", sse16, R16, C16, W16);
+        }
+        if (haveAVX2) {
+            run("avx2 int32", avx32, R32, C32, W32);
+            run("avx2 int16", avx16, R16, C16, W16);
+        }
+        // - Every request fits W = 100, so "passed" also checks the kernels (and keeps the loops from being dropped)
+        int kernelsRun = 2 + 2 * haveSSE2 + 2 * haveAVX2;
+        if (passed != total * (1 + kernelsRun)) {
+            cout << "MISMATCH: " << passed << " of " << total * (1 + kernelsRun) << " checks passed" << endl;
+        }
+    }
+}
+
 // Main Simulation Loop
-int main() {
-    string filename;
-    cout << "Enter input filename: ";
-    cin >> filename;
+// - "--reference" reads the input with readInputFile and runs the original detectDeadlock
+// - "--input FILE" reads the system from FILE instead of asking for a filename
+// - "--generate P R [--seed S] [--deadlock K]" builds a random system instead (K processes deadlocked in a cycle);
+//   "--write FILE" saves it in the input format
+// - Matrices and vectors are printed only while P and R are at most "--print-limit N" (default 20),
+//   and long process lists are cut short
+// - "--events FILE" replays allocate / request / release / check events against the loaded system
+// - When every resource type has a single instance the wait-for graph engine is used and the cycles are reported
+// - "--bench-wfg" compares the engines on generated single-instance systems and exits
+// - "--bench" reports detection time against P and R and exits
+// - "--simd" runs the detectDeadlock reduction with vector kernels ("--kernel scalar|sse2|avx2|auto"),
+//   on int16 rows with "--int16" when all counts fit; "--bench-simd" compares the kernels and exits
+// - "--banker FILE" decides the request queue of a claims file with the Banker's algorithm
+//   ("--batch" also evaluates every request on its own in parallel, on "--threads N" threads)
+int main(int argc, char* argv[]) {
+    bool useReference = false, batch = false, useSIMD = false, useInt16 = false;
+    string eventsFile, claimsFile, inputFile, writeFile, kernelName = "auto";
+    int numThreads = max(1u, thread::hardware_concurrency());
+    int generateProcesses = 0, generateResources = 0, deadlockSize = 0, printLimit = 20;
+    unsigned int seed = 1;
+    const int listLimit = 100;
+    for (int a = 1; a < argc; a++) {
+        string arg = argv[a];
+        if (arg == "--reference") {
+            useReference = true;
+        } else if (arg == "--input" && a + 1 < argc) {
+            inputFile = argv[++a];
+        } else if (arg == "--generate" && a + 2 < argc && atoi(argv[a + 1]) > 0 && atoi(argv[a + 2]) > 0) {
+            generateProcesses = atoi(argv[++a]);
+            generateResources = atoi(argv[++a]);
+        } else if (arg == "--seed" && a + 1 < argc) {
+            seed = strtoul(argv[++a], nullptr, 10);
+        } else if (arg == "--deadlock" && a + 1 < argc && atoi(argv[a + 1]) >= 2) {
+            deadlockSize = atoi(argv[++a]);
+        } else if (arg == "--write" && a + 1 < argc) {
+            writeFile = argv[++a];
+        } else if (arg == "--print-limit" && a + 1 < argc && atoi(argv[a + 1]) >= 0) {
+            printLimit = atoi(argv[++a]);
+        } else if (arg == "--events" && a + 1 < argc) {
+            eventsFile = argv[++a];
+        } else if (arg == "--banker" && a + 1 < argc) {
+            claimsFile = argv[++a];
+        } else if (arg == "--batch") {
+            batch = true;
+        } else if (arg == "--threads" && a + 1 < argc && atoi(argv[a + 1]) > 0) {
+            numThreads = atoi(argv[++a]);
+        } else if (arg == "--bench-wfg") {
+            benchmarkWaitFor();
+            return 0;
+        } else if (arg == "--simd") {
+            useSIMD = true;
+        } else if (arg == "--kernel" && a + 1 < argc) {
+            useSIMD = true;
+            kernelName = argv[++a];
+        } else if (arg == "--int16") {
+            useSIMD = true;
+            useInt16 = true;
+        } else if (arg == "--bench-simd") {
+            benchmarkKernels();
+            return 0;
+        } else if (arg == "--bench") {
+            benchmarkDetection(16000);
+            return 0;
+        } else {
+            cerr << "Usage: " << argv[0] << " [--input FILE | --generate P R [--seed S] [--deadlock K] [--write FILE]]" << endl;
+            cerr << "       " << string(strlen(argv[0]), ' ') << " [--reference | --simd [--kernel scalar|sse2|avx2|auto] [--int16]]" << endl;
+            cerr << "       " << string(strlen(argv[0]), ' ') << " [--print-limit N] [--events FILE]" << endl;
+            cerr << "       " << string(strlen(argv[0]), ' ') << " [--banker CLAIMS [--batch] [--threads N]]" << endl;
+            cerr << "       " << argv[0] << " --bench | --bench-wfg | --bench-simd" << endl;
+            return 1;
+        }
+    }
+
+    ResourceKernels<int32_t> kernels32;
+    ResourceKernels<int16_t> kernels16;
+    if (useSIMD && !pickKernels(kernelName, kernels32, kernels16)) {
+        cerr << "Kernel '" << kernelName << "' is unknown or not supported on this CPU" << endl;
+        return 1;
+    }
 
     int numProcesses, numResources;
     vector<int> E;
     vector<vector<int>> C, R;
 
-    // - Read input from file
-    if (!readInputFile(filename, numProcesses, numResources, E, C, R)) {
-        return 1;
+    if (generateProcesses > 0) {
+        // - Generated system
+        numProcesses = generateProcesses;
+        numResources = generateResources;
+        generateSystem(numProcesses, numResources, seed, deadlockSize, E, C, R);
+        if (!writeFile.empty() && !writeInputFile(writeFile, E, C, R)) {
+            return 1;
+        }
+    } else {
+        string filename = inputFile;
+        if (filename.empty()) {
+            cout << "Enter input filename: ";
+            cin >> filename;
+        }
+
+        // - Read input from file
+        bool loaded = useReference ? readInputFile(filename, numProcesses, numResources, E, C, R)
+                                   : readInputMapped(filename, numProcesses, numResources, E, C, R);
+        if (!loaded) {
+            return 1;
+        }
     }
 
     // - Display input data
     cout << "\n--- Input Data ---" << endl;
     cout << "Number of Processes  : " << numProcesses << endl;
     cout << "Number of Resource Types: " << numResources << endl;
-    printVector("Existence Vector E", E);
-    printVector("Available Vector A", computeAvailable(numProcesses, numResources, E, C));
-    printMatrix("Allocation Matrix C", C, numProcesses, numResources);
-    printMatrix("Request Matrix R   ", R, numProcesses, numResources);
+    if (numProcesses <= printLimit && numResources <= printLimit) {
+        printVector("Existence Vector E", E);
+        printVector("Available Vector A", computeAvailable(numProcesses, numResources, E, C));
+        printMatrix("Allocation Matrix C", C, numProcesses, numResources);
+        printMatrix("Request Matrix R   ", R, numProcesses, numResources);
+    } else {
+        cout << "(vectors and matrices not shown: larger than --print-limit " << printLimit << ")" << endl;
+    }
     cout << endl;
 
     // - Run deadlock detection
-    vector<int> deadlocked = detectDeadlock(numProcesses, numResources, E, C, R);
+    auto start = chrono::steady_clock::now();
+    unique_ptr<DeadlockMonitor> monitor;
+    WaitForGraph graph;
+    WaitForResult waitFor;
+    bool singleInstance = !useReference && !useSIMD && graph.build(E, C, R);
+    vector<int> deadlocked;
+    if (singleInstance) {
+        waitFor = detectWaitForDeadlock(graph);
+        deadlocked = waitFor.deadlocked;
+    } else if (useSIMD) {
+        if (useInt16 && !fitsInt16(E, C, R)) {
+            cout << "(counts do not fit int16, using int32 rows)" << endl;
+            useInt16 = false;
+        }
+        deadlocked = useInt16 ? detectDeadlockSIMD(numProcesses, numResources, E, C, R, kernels16)
+                              : detectDeadlockSIMD(numProcesses, numResources, E, C, R, kernels32);
+    } else if (useReference) {
+        deadlocked = detectDeadlock(numProcesses, numResources, E, C, R);
+    } else {
+        monitor.reset(new DeadlockMonitor(E, C, R));
+        deadlocked = monitor->check();
+    }
+    double detectionMs = chrono::duration<double>(chrono::steady_clock::now() - start).count() * 1000;
 
     // - Output results
     cout << "--- Deadlock Detection Result ---" << endl;
@@ -177,12 +1627,41 @@ int main() {
     } else {
         cout << "DEADLOCK DETECTED!" << endl;
         cout << "Deadlocked processes: ";
-        for (int i = 0; i < (int)deadlocked.size(); i++) {
-            cout << "P" << deadlocked[i];
-            if (i < (int)deadlocked.size() - 1) cout << ", ";
-        }
+        printProcessList(deadlocked, listLimit);
         cout << endl;
     }
 
+    // - Single-instance systems: every cycle of the wait-for graph, with the processes in its component
+    if (singleInstance && !waitFor.cycles.empty()) {
+        cout << "Wait-for cycles:" << endl;
+        for (int c = 0; c < (int)waitFor.cycles.size() && c < listLimit; c++) {
+            cout << "  {";
+            printProcessList(waitFor.components[c], listLimit);
+            cout << "}: ";
+            printProcessList(waitFor.cycles[c], listLimit, " -> ");
+            cout << endl;
+        }
+        if ((int)waitFor.cycles.size() > listLimit) {
+            cout << "  ... (" << waitFor.cycles.size() << " cycles in total)" << endl;
+        }
+    }
+    if (numProcesses > printLimit || numResources > printLimit) {
+        cout << "Detection time: " << fixed << setprecision(2) << detectionMs << " ms" << endl;
+    }
+
+    if (!eventsFile.empty()) {
+        cout << "\n--- Event Replay ---" << endl;
+        if (!monitor) {
+            monitor.reset(new DeadlockMonitor(E, C, R));
+        }
+        if (!replayEvents(eventsFile, *monitor)) {
+            return 1;
+        }
+    }
+
+    if (!claimsFile.empty() && !runBanker(claimsFile, numProcesses, numResources, E, C, batch, numThreads, listLimit)) {
+        return 1;
+    }
+
     return 0;
-}
\ No newline at end of file
+}
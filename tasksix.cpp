@@ -5,6 +5,26 @@
 #include <iomanip>
 #include <string>
 #include <fstream>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <dirent.h>
+#include <unordered_map>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <memory>
 
 using namespace std;
 namespace fs = std::filesystem;
@@ -41,6 +61,803 @@ vector<uintmax_t> getFileSizes(const fs::path& startPath) {
     return fileSizes;
 }
 
+// SizeHistogram Structure: file size statistics updated one file at a time, in O(bins) memory
+// - Linear bins of "binWidth" as buildHistogram makes them: a dense array for the first bins, where most files
+//   fall, and a hash map for the sparse tail
+// - HDR-style buckets for percentiles: sizes below 64 exactly, above that 64 linear sub-buckets per power of
+//   two, so a percentile is reported within 1/64 (1.6%) of the true size whatever the bin width
+// - Every walker thread fills its own and they are merged at the end
+struct SizeHistogram {
+    static const int denseBins = 1 << 14;
+    static const int subBuckets = 64;   // per power of two; log2(subBuckets) = 6
+
+    uintmax_t binWidth = 1;
+    vector<uint64_t> dense;
+    unordered_map<uintmax_t, uint64_t> overflow;   // bin index -> files, for bins >= denseBins
+    vector<uint64_t> hdr;
+    uint64_t count = 0;
+    uintmax_t maxSize = 0;
+
+    SizeHistogram(uintmax_t width = 1) : binWidth(width), dense(denseBins, 0), hdr(subBuckets * 65, 0) {}
+
+    // hdrIndex Function: bucket of "size"; sizes below 64 map to themselves
+    static int hdrIndex(uintmax_t size) {
+        if (size < subBuckets)
+            return size;
+        int e = 63 - __builtin_clzll(size);   // 6..63
+        return subBuckets + (e - 6) * subBuckets + (int)((size >> (e - 6)) & (subBuckets - 1));
+    }
+
+    // hdrHighest Function: largest size that falls into bucket "index"
+    static uintmax_t hdrHighest(int index) {
+        if (index < subBuckets)
+            return index;
+        int e = (index - subBuckets) / subBuckets + 6;
+        uintmax_t low = (uintmax_t)(subBuckets + (index - subBuckets) % subBuckets) << (e - 6);
+        return low + ((uintmax_t)1 << (e - 6)) - 1;
+    }
+
+    void add(uintmax_t size) {
+        uintmax_t bin = size / binWidth;
+        if (bin < denseBins)
+            dense[bin]++;
+        else
+            overflow[bin]++;
+        hdr[hdrIndex(size)]++;
+        count++;
+        maxSize = max(maxSize, size);
+    }
+
+    void merge(const SizeHistogram& other) {
+        for (int b = 0; b < denseBins; b++)
+            dense[b] += other.dense[b];
+        for (const auto& bin : other.overflow)
+            overflow[bin.first] += bin.second;
+        for (int k = 0; k < hdr.size(); k++)
+            hdr[k] += other.hdr[k];
+        count += other.count;
+        maxSize = max(maxSize, other.maxSize);
+    }
+
+    // percentile Function: nearest-rank q-quantile (0..1), as the top of its HDR bucket (never above the max)
+    uintmax_t percentile(double q) const {
+        uint64_t rank = max((uint64_t)1, (uint64_t)ceil(q * count));
+        uint64_t seen = 0;
+        for (int k = 0; k < hdr.size(); k++) {
+            seen += hdr[k];
+            if (seen >= rank)
+                return min(hdrHighest(k), maxSize);
+        }
+        return maxSize;
+    }
+
+    // bins Function: the histogram in the form buildHistogram returns
+    map<uintmax_t, int> bins() const {
+        map<uintmax_t, int> histogram;
+        for (int b = 0; b < denseBins; b++)
+            if (dense[b] > 0)
+                histogram[b * binWidth] = dense[b];
+        for (const auto& bin : overflow)
+            histogram[bin.first * binWidth] = bin.second;
+        return histogram;
+    }
+};
+
+// Parallel Walker
+// - Directories are read with getdents64 into a large buffer, and d_type says what each entry is, so only
+//   regular files (and symlinks, which the original follows to files) need a stat call, and only for the size:
+//   statx with STATX_SIZE and AT_STATX_DONT_SYNC where available, fstatat otherwise, both relative to the
+//   directory fd so the kernel does not walk the path again
+// - Subdirectories are opened with openat relative to their parent's fd, which their tasks share and the last
+//   one closes (DirHandle), so the kernel resolves one component per directory instead of the whole path
+// - Every thread owns a queue of directories still to read; it pushes and pops at the back (depth first, good
+//   locality) and an idle thread steals from the front of another queue, where the oldest, usually largest,
+//   subtrees wait (runWorkStealing, shared with the index scan)
+// - Same semantics as getFileSizes: symlinks to regular files count with the target size, symlinks to
+//   directories are not followed; an unreadable directory is skipped and counted as an error instead of
+//   ending the whole scan
+
+// LinuxDirent64 Structure: one record of the getdents64 buffer
+struct LinuxDirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[1];
+};
+
+// WalkResult Structure: what walkParallel found
+struct WalkResult {
+    SizeHistogram histogram;
+    uint64_t entries = 0;       // directory entries read, of any type
+    uint64_t directories = 0;   // directories opened
+    uint64_t errors = 0;        // directories or entries that could not be read
+    double seconds = 0;
+    int threads = 0;
+};
+
+// WorkQueue Structure: one thread's tasks (directories) still to run
+template <class Task>
+struct WorkQueue {
+    mutex lock;
+    deque<Task> tasks;
+};
+
+// runWorkStealing Function: runs visit(worker, task, children) for "root" and every task added to "children",
+// on "numThreads" threads
+// - A worker pops its own queue at the back and steals from the front of the others, starting at the next one
+// - "pending" counts tasks queued or running; the pool is done when it reaches 0
+template <class Task, class Visit>
+void runWorkStealing(Task root, int numThreads, Visit visit) {
+    vector<WorkQueue<Task>> queues(numThreads);
+    atomic<long long> pending(1);
+    queues[0].tasks.push_back(move(root));
+
+    vector<thread> workers;
+    for (int w = 0; w < numThreads; w++) {
+        workers.push_back(thread([&, w] {
+            Task task;
+            vector<Task> children;
+            int idle = 0;
+            while (true) {
+                bool found = false;
+                for (int k = 0; k < numThreads && !found; k++) {
+                    WorkQueue<Task>& q = queues[(w + k) % numThreads];
+                    lock_guard<mutex> guard(q.lock);
+                    if (!q.tasks.empty()) {
+                        if (k == 0) {
+                            task = move(q.tasks.back());
+                            q.tasks.pop_back();
+                        } else {
+                            task = move(q.tasks.front());
+                            q.tasks.pop_front();
+                        }
+                        found = true;
+                    }
+                }
+                if (!found) {
+                    if (pending.load() == 0)
+                        break;
+                    // - Someone is still running a task that may add more
+                    if (++idle < 64)
+                        this_thread::yield();
+                    else
+                        this_thread::sleep_for(chrono::microseconds(100));
+                    continue;
+                }
+                idle = 0;
+
+                children.clear();
+                visit(w, task, children);
+                if (!children.empty()) {
+                    pending += children.size();
+                    WorkQueue<Task>& q = queues[w];
+                    lock_guard<mutex> guard(q.lock);
+                    for (Task& child : children)
+                        q.tasks.push_back(move(child));
+                }
+                pending--;
+            }
+        }));
+    }
+    for (auto& worker : workers)
+        worker.join();
+}
+
+// sizeAt Helper Function: size of "name" in directory "dirfd"; "follow" resolves symlinks
+// - Returns false when the entry cannot be stat'ed or is not a regular file
+bool sizeAt(int dirfd, const char* name, bool follow, uintmax_t& size) {
+#ifdef STATX_SIZE
+    struct statx stx;
+    int flags = AT_STATX_DONT_SYNC | (follow ? 0 : AT_SYMLINK_NOFOLLOW);
+    if (statx(dirfd, name, flags, STATX_TYPE | STATX_SIZE, &stx) != 0 || !S_ISREG(stx.stx_mode))
+        return false;
+    size = stx.stx_size;
+#else
+    struct stat st;
+    if (fstatat(dirfd, name, &st, follow ? 0 : AT_SYMLINK_NOFOLLOW) != 0 || !S_ISREG(st.st_mode))
+        return false;
+    size = st.st_size;
+#endif
+    return true;
+}
+
+// readDirectory Function: reads the open directory "fd" with getdents64, calling onFile(size) for every regular
+// file (or symlink to one) and onDirectory(name) for every subdirectory; returns the number of entries
+// - "complete", when given, is set to false if getdents64 failed, so not every entry was seen
+template <class OnFile, class OnDirectory>
+uint64_t readDirectory(int fd, vector<char>& buffer, uint64_t& errors, OnFile onFile, OnDirectory onDirectory,
+                       bool* complete = nullptr) {
+    uint64_t entries = 0;
+    while (true) {
+        long bytes = syscall(SYS_getdents64, fd, buffer.data(), buffer.size());
+        if (bytes < 0) {
+            errors++;
+            if (complete != nullptr)
+                *complete = false;
+        }
+        if (bytes <= 0)
+            break;
+        for (long offset = 0; offset < bytes;) {
+            const LinuxDirent64* d = (const LinuxDirent64*)(buffer.data() + offset);
+            offset += d->d_reclen;
+            const char* name = d->d_name;
+            if (name[0] == '.' && (name[1] == 0 || (name[1] == '.' && name[2] == 0)))
+                continue;
+            entries++;
+
+            unsigned char type = d->d_type;
+            if (type == DT_UNKNOWN) {
+                // - Filesystems without d_type: one lstat to find out
+                struct stat entry;
+                if (fstatat(fd, name, &entry, AT_SYMLINK_NOFOLLOW) != 0) {
+                    errors++;
+                    continue;
+                }
+                type = S_ISDIR(entry.st_mode) ? DT_DIR : S_ISREG(entry.st_mode) ? DT_REG
+                     : S_ISLNK(entry.st_mode) ? DT_LNK : DT_UNKNOWN;
+            }
+
+            uintmax_t size;
+            if (type == DT_DIR)
+                onDirectory(name);
+            else if (type == DT_REG && sizeAt(fd, name, false, size))
+                onFile(size);
+            else if (type == DT_LNK && sizeAt(fd, name, true, size))
+                onFile(size);
+        }
+    }
+    return entries;
+}
+
+// joinPath Helper Function: "dir/name", without doubling a trailing slash
+string joinPath(const string& dir, const char* name) {
+    return dir.back() == '/' ? dir + name : dir + "/" + name;
+}
+
+// DirHandle Structure: an open directory shared by the tasks of its subdirectories, closed with the last of them
+// - At most maxShared are held at once, so a wide frontier of queued tasks cannot run out of descriptors; past
+//   that a directory's fd is closed right away and its subdirectories are opened by full path
+struct DirHandle {
+    static const int maxShared = 256;
+    static inline atomic<int> shared{0};
+    int fd;
+
+    explicit DirHandle(int f) : fd(f) {}
+    ~DirHandle() {
+        close(fd);
+        shared--;
+    }
+};
+
+// shareDirectory Helper Function: a handle on "fd" for the subdirectory tasks, or nullptr (fd closed) at the limit
+shared_ptr<DirHandle> shareDirectory(int fd) {
+    if (++DirHandle::shared > DirHandle::maxShared) {
+        DirHandle::shared--;
+        close(fd);
+        return nullptr;
+    }
+    return make_shared<DirHandle>(fd);
+}
+
+// openDirectory Helper Function: opens the directory "path", whose last component starts at "nameOffset"
+// - With a parent handle only that component is resolved (openat), otherwise the whole path
+// - Below the root symlinks are not followed (O_NOFOLLOW), as readDirectory only reports real directories
+int openDirectory(const DirHandle* parent, const string& path, size_t nameOffset, int flags) {
+    flags |= O_DIRECTORY | O_CLOEXEC;
+    if (parent != nullptr)
+        return openat(parent->fd, path.c_str() + nameOffset, flags | O_NOFOLLOW);
+    return open(path.c_str(), nameOffset == 0 ? flags : flags | O_NOFOLLOW);
+}
+
+// statDirectory Helper Function: stat of the directory "path" as openDirectory would find it
+bool statDirectory(const DirHandle* parent, const string& path, size_t nameOffset, struct stat& st) {
+    int r;
+    if (parent != nullptr)
+        r = fstatat(parent->fd, path.c_str() + nameOffset, &st, AT_SYMLINK_NOFOLLOW);
+    else
+        r = nameOffset == 0 ? stat(path.c_str(), &st) : lstat(path.c_str(), &st);
+    return r == 0 && S_ISDIR(st.st_mode);
+}
+
+// WalkTask Structure: a directory still to read; "nameOffset" is 0 for the root only
+struct WalkTask {
+    string path;
+    size_t nameOffset = 0;
+    shared_ptr<DirHandle> parentDir;
+};
+
+// walkParallel Function: histogram of the size of every regular file below "startPath" on "numThreads" threads
+// - Sizes go straight into each thread's SizeHistogram, nothing per file is kept
+WalkResult walkParallel(const string& startPath, int numThreads, uintmax_t binWidth) {
+    WalkResult result;
+    result.histogram = SizeHistogram(binWidth);
+    struct stat st;
+    if (stat(startPath.c_str(), &st) != 0) {
+        cerr << "Error: The given path does not exist." << endl;
+        return result;
+    }
+    if (!S_ISDIR(st.st_mode)) {
+        cerr << "Error: The given path is not a directory." << endl;
+        return result;
+    }
+
+    numThreads = max(1, numThreads);
+    vector<WalkResult> partial(numThreads);
+    vector<vector<char>> buffers(numThreads);
+    for (int w = 0; w < numThreads; w++) {
+        partial[w].histogram = SizeHistogram(binWidth);
+        buffers[w].resize(1 << 17);
+    }
+
+    auto start = chrono::steady_clock::now();
+    WalkTask root;
+    root.path = startPath;
+    runWorkStealing(root, numThreads, [&](int w, const WalkTask& task, vector<WalkTask>& subdirs) {
+        WalkResult& local = partial[w];
+        int fd = openDirectory(task.parentDir.get(), task.path, task.nameOffset, O_RDONLY);
+        if (fd < 0) {
+            local.errors++;
+            return;
+        }
+        local.directories++;
+        local.entries += readDirectory(fd, buffers[w], local.errors,
+                                       [&](uintmax_t size) { local.histogram.add(size); },
+                                       [&](const char* name) {
+                                           WalkTask t;
+                                           t.path = joinPath(task.path, name);
+                                           t.nameOffset = t.path.size() - strlen(name);
+                                           subdirs.push_back(move(t));
+                                       });
+        // - The subdirectories open relative to this one
+        if (subdirs.empty()) {
+            close(fd);
+            return;
+        }
+        shared_ptr<DirHandle> handle = shareDirectory(fd);
+        for (WalkTask& t : subdirs)
+            t.parentDir = handle;
+    });
+    result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    result.threads = numThreads;
+
+    for (const WalkResult& p : partial) {
+        result.histogram.merge(p.histogram);
+        result.entries += p.entries;
+        result.directories += p.directories;
+        result.errors += p.errors;
+    }
+    return result;
+}
+
+// Persistent Index
+// - One record per directory: identity (device, inode, mtime), the bins of the files directly inside it, its
+//   file count and largest file, and its subdirectories; plus the aggregate over the whole tree
+// - A directory's mtime changes whenever an entry is added, removed or renamed in it, so a re-scan stats each
+//   indexed directory and only re-reads those whose identity changed; unchanged ones keep their bins and just
+//   hand their recorded subdirectories on, so a static tree costs one lstat per directory and no per-file work
+// - The aggregate is patched: the old bins of every re-read or vanished directory are taken out and the new
+//   ones put in; only the maximum, which cannot be taken out, is recomputed from the per-directory maxima
+// - Limitation: rewriting a file in place changes its size but not its directory's mtime, so such changes are
+//   only picked up when the directory changes for another reason or with --full
+//
+// File layout, native byte order, every section 8-byte aligned so it is used straight from mmap:
+//   IndexHeader | IndexDir[dirCount] | IndexBin[binCount] | uint32_t children[childCount] | char names[nameBytes]
+
+// IndexHeader Structure: first bytes of an index file
+struct IndexHeader {
+    char magic[8];              // "SIZEIDX1"
+    uint64_t binWidth;
+    uint64_t dirCount, binCount, childCount, nameBytes;
+    uint64_t aggregateOffset, aggregateCount;   // slice of the bins holding the whole tree
+};
+
+// IndexDir Structure: one directory; record 0 is the root and its name is the path the scan started from
+struct IndexDir {
+    uint64_t dev, ino;
+    int64_t mtimeSec, mtimeNsec;
+    uint64_t files, maxSize;
+    uint64_t binOffset, childOffset, nameOffset;
+    uint32_t binCount, childCount, nameLength, reserved;
+};
+
+// IndexBin Structure: a non-empty bin; keys with the top bit set are SizeHistogram HDR buckets, the others
+// linear bin indices
+struct IndexBin {
+    uint64_t key, count;
+};
+
+const uint64_t hdrKey = 1ULL << 63;
+
+// applyBins Helper Function: adds (sign 1) or takes out (sign -1) a list of bins to a SizeHistogram
+void applyBins(SizeHistogram& h, const IndexBin* bins, size_t n, int sign) {
+    for (size_t k = 0; k < n; k++) {
+        uint64_t delta = bins[k].count;
+        if (bins[k].key & hdrKey) {
+            uint64_t& c = h.hdr[bins[k].key & ~hdrKey];
+            c = sign > 0 ? c + delta : c - delta;
+            continue;
+        }
+        uintmax_t bin = bins[k].key;
+        h.count = sign > 0 ? h.count + delta : h.count - delta;
+        if (bin < SizeHistogram::denseBins) {
+            h.dense[bin] = sign > 0 ? h.dense[bin] + delta : h.dense[bin] - delta;
+        } else if (sign > 0) {
+            h.overflow[bin] += delta;
+        } else if ((h.overflow[bin] -= delta) == 0) {
+            h.overflow.erase(bin);
+        }
+    }
+}
+
+// histogramBins Helper Function: the non-empty bins of a SizeHistogram as IndexBins
+vector<IndexBin> histogramBins(const SizeHistogram& h) {
+    vector<IndexBin> bins;
+    for (int b = 0; b < SizeHistogram::denseBins; b++)
+        if (h.dense[b] > 0)
+            bins.push_back({(uint64_t)b, h.dense[b]});
+    for (const auto& bin : h.overflow)
+        bins.push_back({bin.first, bin.second});
+    for (int k = 0; k < h.hdr.size(); k++)
+        if (h.hdr[k] > 0)
+            bins.push_back({hdrKey | k, h.hdr[k]});
+    return bins;
+}
+
+// MappedIndex Structure: an index file opened through mmap, checked for size and bounds
+struct MappedIndex {
+    void* mapping = nullptr;
+    size_t length = 0;
+    const IndexHeader* header = nullptr;
+    const IndexDir* dirs = nullptr;
+    const IndexBin* bins = nullptr;
+    const uint32_t* children = nullptr;
+    const char* names = nullptr;
+
+    ~MappedIndex() {
+        if (mapping != nullptr)
+            munmap(mapping, length);
+    }
+
+    // open Function: false if the file is missing, not an index or inconsistent
+    bool open(const string& filename) {
+        int fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(IndexHeader)) {
+            close(fd);
+            return false;
+        }
+        void* m = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (m == MAP_FAILED)
+            return false;
+        mapping = m;
+        length = st.st_size;
+
+        header = (const IndexHeader*)mapping;
+        if (memcmp(header->magic, "SIZEIDX1", 8) != 0 || header->dirCount == 0 || header->dirCount > UINT32_MAX)
+            return false;
+        uint64_t dirBytes = header->dirCount * sizeof(IndexDir);
+        uint64_t binBytes = header->binCount * sizeof(IndexBin);
+        uint64_t childBytes = (header->childCount * sizeof(uint32_t) + 7) & ~7ULL;
+        if (header->binCount > length || header->childCount > length || header->nameBytes > length ||
+            sizeof(IndexHeader) + dirBytes + binBytes + childBytes + header->nameBytes != length)
+            return false;
+        dirs = (const IndexDir*)((const char*)mapping + sizeof(IndexHeader));
+        bins = (const IndexBin*)((const char*)dirs + dirBytes);
+        children = (const uint32_t*)((const char*)bins + binBytes);
+        names = (const char*)children + childBytes;
+
+        if (!inside(header->aggregateOffset, header->aggregateCount, header->binCount))
+            return false;
+        for (uint64_t i = 0; i < header->dirCount; i++) {
+            const IndexDir& d = dirs[i];
+            if (!inside(d.binOffset, d.binCount, header->binCount) ||
+                !inside(d.childOffset, d.childCount, header->childCount) ||
+                !inside(d.nameOffset, d.nameLength, header->nameBytes))
+                return false;
+        }
+        for (uint64_t k = 0; k < header->childCount; k++)
+            if (children[k] == 0 || children[k] >= header->dirCount)
+                return false;
+        for (uint64_t k = 0; k < header->binCount; k++)
+            if ((bins[k].key & hdrKey) && (bins[k].key & ~hdrKey) >= SizeHistogram::subBuckets * 65)
+                return false;
+        return true;
+    }
+
+    // inside Function: [offset, offset + count) lies within [0, total), without the sum wrapping around
+    static bool inside(uint64_t offset, uint64_t count, uint64_t total) {
+        return offset <= total && count <= total - offset;
+    }
+
+    string_view name(uint64_t i) const { return string_view(names + dirs[i].nameOffset, dirs[i].nameLength); }
+};
+
+// IndexedDir Structure: a directory as the current scan found it
+struct IndexedDir {
+    uint64_t dev = 0, ino = 0;
+    int64_t mtimeSec = 0, mtimeNsec = 0;
+    uint64_t files = 0, maxSize = 0;
+    uint32_t id = 0, parent = UINT32_MAX;
+    int64_t old = -1;       // its record in the previous index, -1 if new
+    bool reread = false;    // read again rather than taken from the previous index
+    string name;
+    vector<IndexBin> bins;
+};
+
+// IndexTask Structure: a directory waiting to be checked
+struct IndexTask {
+    string path, name;
+    int64_t old = -1;
+    uint32_t id = 0, parent = UINT32_MAX;
+    shared_ptr<DirHandle> parentDir;   // opened relative to it when set
+};
+
+// IndexScanResult Structure: the patched aggregate and what the re-scan had to do
+struct IndexScanResult {
+    SizeHistogram histogram;
+    uint64_t directories = 0, reread = 0, removed = 0, entries = 0, errors = 0;
+    bool incremental = false;
+    double seconds = 0;
+    int threads = 0;
+};
+
+// writeIndex Function: writes the directories of this scan and the aggregate, through a temporary file and rename
+bool writeIndex(const string& filename, uintmax_t binWidth, const vector<IndexedDir>& dirs, const SizeHistogram& aggregate) {
+    // - Children lists from the parent links, with a counting pass
+    vector<uint32_t> childCount(dirs.size(), 0), childStart(dirs.size() + 1, 0);
+    for (size_t i = 1; i < dirs.size(); i++)
+        childCount[dirs[i].parent]++;
+    for (size_t i = 0; i < dirs.size(); i++)
+        childStart[i + 1] = childStart[i] + childCount[i];
+    vector<uint32_t> children(dirs.size() > 0 ? dirs.size() - 1 : 0);
+    vector<uint32_t> fill(childStart.begin(), childStart.end() - 1);
+    for (size_t i = 1; i < dirs.size(); i++)
+        children[fill[dirs[i].parent]++] = i;
+
+    vector<IndexBin> aggregateBins = histogramBins(aggregate);
+    IndexHeader header;
+    memcpy(header.magic, "SIZEIDX1", 8);
+    header.binWidth = binWidth;
+    header.dirCount = dirs.size();
+    header.childCount = children.size();
+    header.binCount = aggregateBins.size();
+    header.nameBytes = 0;
+    vector<IndexDir> records(dirs.size());
+    for (size_t i = 0; i < dirs.size(); i++) {
+        const IndexedDir& d = dirs[i];
+        IndexDir& r = records[i];
+        r.dev = d.dev;
+        r.ino = d.ino;
+        r.mtimeSec = d.mtimeSec;
+        r.mtimeNsec = d.mtimeNsec;
+        r.files = d.files;
+        r.maxSize = d.maxSize;
+        r.binOffset = header.binCount;
+        r.binCount = d.bins.size();
+        r.childOffset = childStart[i];
+        r.childCount = childCount[i];
+        r.nameOffset = header.nameBytes;
+        r.nameLength = d.name.size();
+        r.reserved = 0;
+        header.binCount += d.bins.size();
+        header.nameBytes += d.name.size();
+    }
+    header.aggregateOffset = 0;
+    header.aggregateCount = aggregateBins.size();
+    // - Pad the names so the file length is the exact sum MappedIndex checks
+    uint64_t childBytes = children.size() * sizeof(uint32_t);
+    uint64_t childPadding = ((childBytes + 7) & ~7ULL) - childBytes;
+
+    string temporary = filename + ".tmp";
+    FILE* out = fopen(temporary.c_str(), "wb");
+    if (out == nullptr) {
+        cerr << "Error: Could not create index file '" << temporary << "'" << endl;
+        return false;
+    }
+    fwrite(&header, sizeof(header), 1, out);
+    fwrite(records.data(), sizeof(IndexDir), records.size(), out);
+    fwrite(aggregateBins.data(), sizeof(IndexBin), aggregateBins.size(), out);
+    for (const IndexedDir& d : dirs)
+        fwrite(d.bins.data(), sizeof(IndexBin), d.bins.size(), out);
+    fwrite(children.data(), sizeof(uint32_t), children.size(), out);
+    const char zeros[8] = {0};
+    fwrite(zeros, 1, childPadding, out);
+    for (const IndexedDir& d : dirs)
+        fwrite(d.name.data(), 1, d.name.size(), out);
+    bool ok = !ferror(out);
+    ok = fclose(out) == 0 && ok;
+    if (!ok || rename(temporary.c_str(), filename.c_str()) != 0) {
+        cerr << "Error: Could not write index file '" << filename << "'" << endl;
+        unlink(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+// scanWithIndex Function: histogram of "startPath" using and refreshing the index in "indexFile"
+// - Without a usable index for the same root and bin width (or with "full") every directory is read
+bool scanWithIndex(const string& startPath, uintmax_t binWidth, int numThreads, const string& indexFile, bool full,
+                   IndexScanResult& result) {
+    struct stat st;
+    if (stat(startPath.c_str(), &st) != 0) {
+        cerr << "Error: The given path does not exist." << endl;
+        return false;
+    }
+    if (!S_ISDIR(st.st_mode)) {
+        cerr << "Error: The given path is not a directory." << endl;
+        return false;
+    }
+
+    MappedIndex previous;
+    bool usable = !full && previous.open(indexFile) && previous.header->binWidth == binWidth &&
+                  previous.name(0) == startPath;
+    result.incremental = usable;
+    result.histogram = SizeHistogram(binWidth);
+    if (usable)
+        applyBins(result.histogram, previous.bins + previous.header->aggregateOffset, previous.header->aggregateCount, 1);
+
+    numThreads = max(1, numThreads);
+    result.threads = numThreads;
+    atomic<uint32_t> nextId(1);
+    vector<vector<IndexedDir>> found(numThreads);
+    vector<vector<char>> buffers(numThreads);
+    vector<uint64_t> entries(numThreads, 0), errors(numThreads, 0);
+    vector<char> visited(usable ? previous.header->dirCount : 0, 0);
+    for (int w = 0; w < numThreads; w++)
+        buffers[w].resize(1 << 17);
+
+    IndexTask root;
+    root.path = startPath;
+    root.name = startPath;
+    root.old = usable ? 0 : -1;
+
+    auto start = chrono::steady_clock::now();
+    runWorkStealing(root, numThreads, [&](int w, const IndexTask& task, vector<IndexTask>& subdirs) {
+        // - Identity first: stat before reading, so a change during the read shows up next time
+        // - fstatat relative to the parent resolves one component; an unchanged directory without subdirectories
+        //   needs nothing else, the others are opened (dirfd) and handed to their subdirectories
+        size_t nameOffset = task.id == 0 ? 0 : task.path.size() - task.name.size();
+        const DirHandle* parentDir = task.parentDir.get();
+        struct stat ds;
+        bool ok = statDirectory(parentDir, task.path, nameOffset, ds);
+        if (!ok) {
+            errors[w]++;
+            ds = {};
+        }
+        IndexedDir d;
+        auto identify = [&](const struct stat& st) {
+            d.dev = st.st_dev;
+            d.ino = st.st_ino;
+            d.mtimeSec = st.st_mtim.tv_sec;
+            d.mtimeNsec = st.st_mtim.tv_nsec;
+        };
+        identify(ds);
+        const struct stat unknown = {};
+        d.id = task.id;
+        d.parent = task.parent;
+        d.old = task.old;
+        d.name = task.name;
+        if (task.old >= 0)
+            visited[task.old] = 1;
+
+        auto child = [&](const string& name, int64_t old) {
+            IndexTask t;
+            t.path = joinPath(task.path, name.c_str());
+            t.name = name;
+            t.old = old;
+            t.id = nextId++;
+            t.parent = task.id;
+            subdirs.push_back(move(t));
+        };
+
+        int dirfd = -1;
+        const IndexDir* old = task.old >= 0 ? &previous.dirs[task.old] : nullptr;
+        if (old != nullptr && ok && old->dev == d.dev && old->ino == d.ino && old->mtimeSec == d.mtimeSec &&
+            old->mtimeNsec == d.mtimeNsec) {
+            // - Unchanged: keep its bins, check its subdirectories
+            d.files = old->files;
+            d.maxSize = old->maxSize;
+            d.bins.assign(previous.bins + old->binOffset, previous.bins + old->binOffset + old->binCount);
+            if (old->childCount > 0)
+                dirfd = openDirectory(parentDir, task.path, nameOffset, O_PATH);
+            for (uint32_t k = 0; k < old->childCount; k++) {
+                uint32_t c = previous.children[old->childOffset + k];
+                child(string(previous.name(c)), c);
+            }
+        } else {
+            // - A directory that could not be read completely gets no identity (inode 0 never matches), so the next
+            //   run reads it again: fixing its permissions changes only its ctime, not its mtime
+            d.reread = true;
+            dirfd = ok ? openDirectory(parentDir, task.path, nameOffset, O_RDONLY) : -1;
+            if (dirfd < 0) {
+                if (ok)
+                    errors[w]++;
+                identify(unknown);
+            } else {
+                // - The identity of the directory actually read
+                if (fstat(dirfd, &ds) == 0)
+                    identify(ds);
+                // - Subdirectories that were indexed before keep their records, so only this level is re-read
+                unordered_map<string_view, uint32_t> known;
+                if (old != nullptr)
+                    for (uint32_t k = 0; k < old->childCount; k++) {
+                        uint32_t c = previous.children[old->childOffset + k];
+                        known[previous.name(c)] = c;
+                    }
+                vector<uint64_t> keys;
+                bool complete = true;
+                entries[w] += readDirectory(dirfd, buffers[w], errors[w],
+                    [&](uintmax_t size) {
+                        keys.push_back(size / binWidth);
+                        keys.push_back(hdrKey | SizeHistogram::hdrIndex(size));
+                        d.files++;
+                        d.maxSize = max(d.maxSize, (uint64_t)size);
+                    },
+                    [&](const char* name) {
+                        auto it = known.find(string_view(name));
+                        child(name, it == known.end() ? -1 : (int64_t)it->second);
+                    },
+                    &complete);
+                if (!complete)
+                    identify(unknown);
+                sort(keys.begin(), keys.end());
+                for (size_t k = 0; k < keys.size(); k++) {
+                    if (d.bins.empty() || d.bins.back().key != keys[k])
+                        d.bins.push_back({keys[k], 0});
+                    d.bins.back().count++;
+                }
+            }
+        }
+        found[w].push_back(move(d));
+
+        if (dirfd < 0)
+            return;
+        if (subdirs.empty()) {
+            close(dirfd);
+            return;
+        }
+        shared_ptr<DirHandle> handle = shareDirectory(dirfd);
+        for (IndexTask& t : subdirs)
+            t.parentDir = handle;
+    });
+    result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // - Results by id, so writeIndex can rebuild the children lists from the parent links
+    vector<IndexedDir> dirs(nextId.load());
+    for (int w = 0; w < numThreads; w++) {
+        result.entries += entries[w];
+        result.errors += errors[w];
+        for (IndexedDir& d : found[w])
+            dirs[d.id] = move(d);
+    }
+
+    // - Patch the aggregate: out with the old bins of what was re-read or is gone, in with the new
+    for (const IndexedDir& d : dirs) {
+        if (!d.reread)
+            continue;
+        result.reread++;
+        if (d.old >= 0)
+            applyBins(result.histogram, previous.bins + previous.dirs[d.old].binOffset, previous.dirs[d.old].binCount, -1);
+        applyBins(result.histogram, d.bins.data(), d.bins.size(), 1);
+    }
+    for (size_t i = 0; i < visited.size(); i++) {
+        if (visited[i])
+            continue;
+        result.removed++;
+        applyBins(result.histogram, previous.bins + previous.dirs[i].binOffset, previous.dirs[i].binCount, -1);
+    }
+    result.histogram.maxSize = 0;
+    for (const IndexedDir& d : dirs)
+        result.histogram.maxSize = max(result.histogram.maxSize, (uintmax_t)d.maxSize);
+    result.directories = dirs.size();
+
+    return writeIndex(indexFile, binWidth, dirs, result.histogram);
+}
+
 // buildHistogram Function: Groups the collected file sizes into bins based on the given bin width
 map<uintmax_t, int> buildHistogram(const vector<uintmax_t>& fileSizes, uintmax_t binWidth) {
     map<uintmax_t, int> histogram;
@@ -93,9 +910,36 @@ void saveHistogramToCSV(const map<uintmax_t, int>& histogram, uintmax_t binWidth
     cout << "Histogram data saved to histogram.csv" << endl;
 }
 
+// Main
+// - Usage: tasksix <directory_path> <bin_width_in_bytes> [--threads N] [--reference]
+// - --threads bounds the walker threads (default: one per core; more can help on high-latency filesystems)
+// - --reference walks with the original single-threaded getFileSizes
+// - --index FILE keeps a per-directory index and re-reads only directories whose mtime changed (see Persistent
+//   Index); --full re-reads everything and rewrites the index
 int main(int argc, char* argv[]) {
-    if (argc != 3) {
-        cerr << "Usage: " << argv[0] << " <directory_path> <bin_width_in_bytes>" << endl;
+    int numThreads = max(1u, thread::hardware_concurrency());
+    bool useReference = false;
+    string indexFile;
+    bool fullScan = false;
+    bool badOption = argc < 3;
+    for (int a = 3; a < argc && !badOption; a++) {
+        string arg = argv[a];
+        if (arg == "--threads" && a + 1 < argc && atoi(argv[a + 1]) > 0) {
+            numThreads = atoi(argv[++a]);
+        } else if (arg == "--reference") {
+            useReference = true;
+        } else if (arg == "--index" && a + 1 < argc) {
+            indexFile = argv[++a];
+        } else if (arg == "--full") {
+            fullScan = true;
+        } else {
+            badOption = true;
+        }
+    }
+    if (useReference && !indexFile.empty())
+        badOption = true;
+    if (badOption) {
+        cerr << "Usage: " << argv[0] << " <directory_path> <bin_width_in_bytes> [--threads N] [--reference | --index FILE [--full]]" << endl;
         cerr << "Example: " << argv[0] << " /home/user/documents 1024" << endl;
         return 1;
     }
@@ -119,18 +963,76 @@ int main(int argc, char* argv[]) {
     }
 
     // Getting all file sizes from the given directory
-    vector<uintmax_t> fileSizes = getFileSizes(directoryPath);
+    // - The parallel walker streams them into per-thread histograms; the reference collects a vector first
+    WalkResult walk;
+    IndexScanResult indexed;
+    map<uintmax_t, int> histogram;
+    uint64_t totalFiles = 0;
+    uintmax_t p50 = 0, p99 = 0, maxSize = 0;
+    if (useReference) {
+        auto start = chrono::steady_clock::now();
+        vector<uintmax_t> fileSizes = getFileSizes(directoryPath);
+        walk.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        totalFiles = fileSizes.size();
+        if (totalFiles > 0) {
+            // Building the histogram from the collected file sizes
+            histogram = buildHistogram(fileSizes, binWidth);
+            // - Exact nearest-rank percentiles
+            auto rank = [&](double q) {
+                size_t k = max((size_t)1, (size_t)ceil(q * totalFiles)) - 1;
+                nth_element(fileSizes.begin(), fileSizes.begin() + k, fileSizes.end());
+                return fileSizes[k];
+            };
+            p50 = rank(0.50);
+            p99 = rank(0.99);
+            maxSize = *max_element(fileSizes.begin(), fileSizes.end());
+        }
+    } else {
+        if (indexFile.empty()) {
+            walk = walkParallel(directoryPath, numThreads, binWidth);
+        } else {
+            if (!scanWithIndex(directoryPath, binWidth, numThreads, indexFile, fullScan, indexed))
+                return 1;
+            walk.histogram = move(indexed.histogram);
+            walk.entries = indexed.entries;
+            walk.directories = indexed.reread;
+            walk.errors = indexed.errors;
+            walk.seconds = indexed.seconds;
+            walk.threads = indexed.threads;
+        }
+        totalFiles = walk.histogram.count;
+        if (totalFiles > 0) {
+            histogram = walk.histogram.bins();
+            p50 = walk.histogram.percentile(0.50);
+            p99 = walk.histogram.percentile(0.99);
+            maxSize = walk.histogram.maxSize;
+        }
+    }
 
-    if (fileSizes.empty()) {
+    if (totalFiles == 0) {
         cout << "No files found, or the directory could not be read." << endl;
         return 0;
     }
 
-    // Building the histogram from the collected file sizes
-    map<uintmax_t, int> histogram = buildHistogram(fileSizes, binWidth);
-
     // Printing the total number of files and the histogram
-    cout << "\nTotal files scanned: " << fileSizes.size() << endl;
+    cout << "\nTotal files scanned: " << totalFiles << endl;
+    if (useReference) {
+        cout << "Scan time: " << fixed << setprecision(3) << walk.seconds << " s (reference walker)" << endl;
+    } else {
+        cout << "Entries walked: " << walk.entries << " in " << walk.directories << " directories, " << walk.threads
+             << " threads, " << fixed << setprecision(3) << walk.seconds << " s ("
+             << setprecision(0) << walk.entries / max(walk.seconds, 1e-9) << " entries/sec)" << endl;
+        if (walk.errors > 0)
+            cout << "Unreadable directories or entries skipped: " << walk.errors << endl;
+        if (!indexFile.empty())
+            cout << "Index: " << indexed.directories << " directories, " << indexed.reread << " re-read, "
+                 << indexed.directories - indexed.reread << " unchanged, " << indexed.removed << " removed"
+                 << (indexed.incremental ? "" : " (full scan)") << endl;
+    }
+    cout.unsetf(ios::floatfield);
+    cout.precision(6);
+    cout << "File size p50: " << p50 << " bytes, p99: " << p99 << " bytes, max: " << maxSize << " bytes"
+         << (useReference ? "" : " (percentiles within 1.6%)") << endl;
     printHistogram(histogram, binWidth);
 
     // Saving the histogram data into a CSV file
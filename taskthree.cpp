@@ -2,6 +2,25 @@
 #include <vector>
 #include <fstream>
 #include <iomanip>
+#include <string>
+#include <cstdint>
+#include <climits>
+#include <list>
+#include <unordered_map>
+#include <set>
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <chrono>
+#include <cstring>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 using namespace std;
 
 // Frame Structure: to hold page number and aging register
@@ -62,6 +81,845 @@ int simulateAging(const vector<int>& references, int numFrames) {
     return pageFaults;
 }
 
+// forEachReference Function: calls "visit(page)" for every reference of an in-memory trace, in order
+// - Simulators are written against forEachReference/traceSize so they also run on a MappedTrace
+template <class Visit>
+void forEachReference(const vector<int>& references, Visit visit) {
+    for (int i = 0; i < (int)references.size(); i++) {
+        visit(references[i]);
+    }
+}
+
+inline long long traceSize(const vector<int>& references) {
+    return references.size();
+}
+
+// Binary Trace Format (".pgt"), all integers little-endian:
+// - Header (40 bytes): "PGTR", u32 version (1), u64 reference count, u32 page size in bytes,
+//   u32 references per block, u64 block count, u64 file offset of the block index
+// - Blocks: u32 references in the block, u32 payload bytes, then one varint per reference holding the
+//   zigzag-encoded difference from the previous page of the same block (the first one is relative to 0)
+// - Block index: u64 file offset of every block, so a reader can start at any block
+// - Blocks are independent, which keeps decoding simple and lets a reader skip or split the trace by block
+struct TraceHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t count;
+    uint32_t pageSize;
+    uint32_t blockRefs;
+    uint64_t numBlocks;
+    uint64_t indexOffset;
+};
+
+// MappedTrace Structure: Streaming reader over a memory-mapped binary trace
+// - Opening checks the header and the block index (every block and its payload inside the file, the block
+//   reference counts adding up to the header count), which is O(blocks), so startup stays instant
+// - forEach decodes block by block straight from the mapping; nothing per reference is kept in memory
+struct MappedTrace {
+    const unsigned char* data = nullptr;
+    size_t bytes = 0;
+    TraceHeader header;
+
+    MappedTrace() {}
+    MappedTrace(const MappedTrace&) = delete;
+    MappedTrace& operator=(const MappedTrace&) = delete;
+
+    ~MappedTrace() {
+        if (data != nullptr) {
+            munmap((void*)data, bytes);
+        }
+    }
+
+    // open Function: maps "filename"; returns false if it cannot be mapped or is not a binary trace
+    bool open(const string& filename) {
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(TraceHeader)) {
+            close(fd);
+            return false;
+        }
+        void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED) {
+            return false;
+        }
+        data = (const unsigned char*)p;
+        bytes = st.st_size;
+        memcpy(&header, data, sizeof(header));
+        if (memcmp(header.magic, "PGTR", 4) != 0 || header.version != 1 || !validIndex()) {
+            munmap(p, bytes);
+            data = nullptr;
+            return false;
+        }
+        madvise(p, bytes, MADV_SEQUENTIAL);
+        return true;
+    }
+
+    // validIndex Function: the block index and every block header it points to lie inside the file
+    // - Checked without overflow: numBlocks is bounded by the file size before anything is multiplied by it
+    bool validIndex() const {
+        if (header.indexOffset > bytes || header.numBlocks > (bytes - header.indexOffset) / 8) {
+            return false;
+        }
+        uint64_t total = 0;
+        for (uint64_t b = 0; b < header.numBlocks; b++) {
+            uint64_t offset;
+            uint32_t refs, payload;
+            memcpy(&offset, data + header.indexOffset + b * 8, 8);
+            if (offset < sizeof(TraceHeader) || offset > bytes - 8) {
+                return false;
+            }
+            memcpy(&refs, data + offset, 4);
+            memcpy(&payload, data + offset + 4, 4);
+            // - Every reference takes at least one varint byte
+            if (payload > bytes - offset - 8 || refs > payload) {
+                return false;
+            }
+            total += refs;
+        }
+        return total == header.count;
+    }
+
+    long long size() const { return header.count; }
+
+    template <class Visit>
+    void forEach(Visit visit) const {
+        for (uint64_t b = 0; b < header.numBlocks; b++) {
+            uint64_t offset;
+            memcpy(&offset, data + header.indexOffset + b * 8, 8);
+            const unsigned char* p = data + offset;
+            uint32_t refs, payload;
+            memcpy(&refs, p, 4);
+            memcpy(&payload, p + 4, 4);
+            p += 8;
+            // - open checked the payload is inside the file; decoding never reads past it
+            const unsigned char* end = p + payload;
+            int64_t page = 0;
+            for (uint32_t r = 0; r < refs && p < end; r++) {
+                uint64_t v = 0;
+                int shift = 0;
+                while (p < end && (*p & 0x80)) {
+                    if (shift < 64) {
+                        v |= (uint64_t)(*p & 0x7f) << shift;
+                    }
+                    p++;
+                    shift += 7;
+                }
+                if (p == end) {
+                    break;
+                }
+                if (shift < 64) {
+                    v |= (uint64_t)*p << shift;
+                }
+                p++;
+                page += (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+                visit((int)page);
+            }
+        }
+    }
+
+    // toVector Function: decodes the whole trace, only used by the slow reference simulators
+    vector<int> toVector() const {
+        vector<int> references;
+        references.reserve(size());
+        forEach([&](int page) { references.push_back(page); });
+        return references;
+    }
+};
+
+template <class Visit>
+void forEachReference(const MappedTrace& trace, Visit visit) {
+    trace.forEach(visit);
+}
+
+inline long long traceSize(const MappedTrace& trace) {
+    return trace.size();
+}
+
+// convertTrace Function: converts a whitespace separated text trace into the binary format, streaming
+// - The text is parsed in large buffered reads, so the converter never holds more than one block of references
+bool convertTrace(const string& textFile, const string& binaryFile, uint32_t pageSize) {
+    FILE* in = fopen(textFile.c_str(), "rb");
+    if (in == nullptr) {
+        cout << "Error opening file.\n";
+        return false;
+    }
+    FILE* out = fopen(binaryFile.c_str(), "wb");
+    if (out == nullptr) {
+        cout << "Error creating " << binaryFile << ".\n";
+        fclose(in);
+        return false;
+    }
+
+    const uint32_t blockRefs = 1 << 16;
+    TraceHeader header;
+    memcpy(header.magic, "PGTR", 4);
+    header.version = 1;
+    header.count = 0;
+    header.pageSize = pageSize;
+    header.blockRefs = blockRefs;
+    header.numBlocks = 0;
+    header.indexOffset = 0;
+    fwrite(&header, sizeof(header), 1, out);
+
+    vector<uint64_t> index;
+    vector<unsigned char> payload;
+    uint32_t inBlock = 0;
+    int64_t previous = 0;
+    uint64_t offset = sizeof(header);
+
+    auto flushBlock = [&]() {
+        if (inBlock == 0) {
+            return;
+        }
+        uint32_t sizes[2] = {inBlock, (uint32_t)payload.size()};
+        fwrite(sizes, sizeof(sizes), 1, out);
+        fwrite(payload.data(), 1, payload.size(), out);
+        index.push_back(offset);
+        offset += sizeof(sizes) + payload.size();
+        payload.clear();
+        inBlock = 0;
+        previous = 0;
+    };
+    auto addPage = [&](int64_t page) {
+        int64_t delta = page - previous;
+        uint64_t v = ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63);
+        while (v >= 0x80) {
+            payload.push_back((unsigned char)(v | 0x80));
+            v >>= 7;
+        }
+        payload.push_back((unsigned char)v);
+        previous = page;
+        header.count++;
+        if (++inBlock == blockRefs) {
+            flushBlock();
+        }
+    };
+
+    // - Hand-rolled integer parser over 1 MB reads; a number may continue across two reads
+    vector<char> buffer(1 << 20);
+    int64_t value = 0;
+    bool inNumber = false, negative = false;
+    size_t got;
+    while ((got = fread(buffer.data(), 1, buffer.size(), in)) > 0) {
+        for (size_t k = 0; k < got; k++) {
+            char c = buffer[k];
+            if (c >= '0' && c <= '9') {
+                value = value * 10 + (c - '0');
+                inNumber = true;
+            } else if (c == '-' && !inNumber) {
+                negative = true;
+            } else {
+                if (inNumber) {
+                    addPage(negative ? -value : value);
+                }
+                value = 0;
+                inNumber = false;
+                negative = false;
+            }
+        }
+    }
+    if (inNumber) {
+        addPage(negative ? -value : value);
+    }
+    flushBlock();
+
+    header.numBlocks = index.size();
+    header.indexOffset = offset;
+    fwrite(index.data(), sizeof(uint64_t), index.size(), out);
+    fseek(out, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, out);
+
+    bool ok = !ferror(out);
+    fclose(out);
+    fclose(in);
+    cout << "Converted " << header.count << " references into " << header.numBlocks << " blocks ("
+         << offset + index.size() * 8 << " bytes)" << endl;
+    return ok;
+}
+
+// PageIndex Structure: Open addressing hash map from page number to the frame holding it
+// - Linear probing; deletions shift the following entries back so no tombstones are needed
+// - Sized once for "maxPages" resident pages at a load factor of at most 50%
+struct PageIndex {
+    vector<int> keys;
+    vector<int> frames;   // -1 marks an empty slot
+    size_t mask;
+
+    explicit PageIndex(int maxPages) {
+        size_t size = 16;
+        while (size < (size_t)maxPages * 2) {
+            size *= 2;
+        }
+        keys.assign(size, 0);
+        frames.assign(size, -1);
+        mask = size - 1;
+    }
+
+    size_t slotOf(int page) const {
+        uint32_t h = (uint32_t)page * 2654435761u;
+        return (h ^ (h >> 16)) & mask;
+    }
+
+    // find Function: Frame holding "page", or -1 when the page is not resident
+    int find(int page) const {
+        for (size_t s = slotOf(page); frames[s] != -1; s = (s + 1) & mask) {
+            if (keys[s] == page) {
+                return frames[s];
+            }
+        }
+        return -1;
+    }
+
+    void insert(int page, int frame) {
+        size_t s = slotOf(page);
+        while (frames[s] != -1) {
+            s = (s + 1) & mask;
+        }
+        keys[s] = page;
+        frames[s] = frame;
+    }
+
+    void erase(int page) {
+        size_t s = slotOf(page);
+        while (keys[s] != page || frames[s] == -1) {
+            s = (s + 1) & mask;
+        }
+        // - Backward shift: move later entries of the probe run into the hole when their home slot allows it
+        size_t hole = s;
+        for (size_t next = (s + 1) & mask; frames[next] != -1; next = (next + 1) & mask) {
+            size_t home = slotOf(keys[next]);
+            if (((next - home) & mask) >= ((next - hole) & mask)) {
+                keys[hole] = keys[next];
+                frames[hole] = frames[next];
+                hole = next;
+            }
+        }
+        frames[hole] = -1;
+    }
+};
+
+// FrameSet Structure: Set of frame indices with O(log64 n) insert, erase and "smallest member"
+// - A hierarchy of bitmaps: bit i of level k+1 is set when word i of level k is not empty
+struct FrameSet {
+    vector<vector<uint64_t>> levels;
+
+    explicit FrameSet(int numFrames) {
+        size_t bits = max(numFrames, 1);
+        do {
+            bits = (bits + 63) / 64;
+            levels.push_back(vector<uint64_t>(bits, 0));
+        } while (bits > 1);
+    }
+
+    bool empty() const { return levels.back()[0] == 0; }
+
+    void insert(int frame) {
+        size_t i = frame;
+        for (size_t k = 0; k < levels.size(); k++) {
+            bool wasEmpty = levels[k][i / 64] == 0;
+            levels[k][i / 64] |= 1ull << (i % 64);
+            if (!wasEmpty) {
+                return;
+            }
+            i /= 64;
+        }
+    }
+
+    void erase(int frame) {
+        size_t i = frame;
+        for (size_t k = 0; k < levels.size(); k++) {
+            levels[k][i / 64] &= ~(1ull << (i % 64));
+            if (levels[k][i / 64] != 0) {
+                return;
+            }
+            i /= 64;
+        }
+    }
+
+    // first Function: Smallest frame in the set, the set must not be empty
+    int first() const {
+        size_t i = 0;
+        for (size_t k = levels.size(); k-- > 0;) {
+            i = i * 64 + __builtin_ctzll(levels[k][i]);
+        }
+        return i;
+    }
+};
+
+// Replacement Policy Interface: every policy is a structure with
+// - a constructor taking the number of frames
+// - "bool access(int page)", called once per reference in trace order, returning true on a page fault
+// runPolicy is the shared reference loop, so policies only hold their own frames and bookkeeping
+template <class Policy, class Trace>
+int runPolicy(const Trace& references, Policy& policy) {
+    int pageFaults = 0;
+    forEachReference(references, [&](int page) {
+        pageFaults += policy.access(page);
+    });
+    return pageFaults;
+}
+
+// AgingPolicy Structure: same result as simulateAging, without touching every frame on each reference
+// - Lazy shifting: each frame keeps the register value it had when it was last referenced ("age") and that time
+//   ("lastUse"); its current register is age >> (now - lastUse), which is 0 once 32 references have gone by
+// - Only pages referenced in the last 32 references can have a non-zero register, so:
+//     - if any frame has a register of 0, the victim is the lowest such frame (the original scan keeps the first minimum),
+//       kept in a FrameSet that a frame joins 32 references after its last use
+//     - otherwise the victim is found among at most 32 recently used frames (a fixed-size SoA min-search)
+// - A PageIndex replaces the linear search for the referenced page
+// - Cost per reference is O(1) apart from the O(log64 frames) FrameSet updates
+struct AgingPolicy {
+    static const int window = 32;
+    int numFrames;
+    vector<Frame> frames;       // page and aging register as of the frame's last use
+    vector<int> lastUse;
+    PageIndex index;
+    FrameSet idle;              // frames whose aging register has decayed to 0
+    int recent[window];         // recent[t % 32] = frame referenced at time t
+    int t = 0;
+
+    explicit AgingPolicy(int numFrames) : numFrames(numFrames), lastUse(numFrames), index(numFrames), idle(numFrames) {
+        frames.reserve(numFrames);
+        for (int k = 0; k < window; k++) {
+            recent[k] = -1;
+        }
+    }
+
+    bool access(int ref) {
+        int slot = t % window;
+        bool fault = false;
+
+        // - The frame referenced 32 references ago has now been shifted to 0, unless it was referenced again since
+        if (t >= window && lastUse[recent[slot]] == t - window) {
+            idle.insert(recent[slot]);
+        }
+
+        int f = index.find(ref);
+        if (f != -1) {
+            // - Hit: bring the register up to date, then set its MSB
+            int gap = t - lastUse[f];
+            if (gap >= window) {
+                idle.erase(f);
+                frames[f].age = 0;
+            } else {
+                frames[f].age >>= gap;
+            }
+            frames[f].age |= (1u << 31);
+        }
+        else {
+            fault = true;
+
+            if ((int)frames.size() < numFrames) {
+                f = frames.size();
+                frames.push_back(Frame());
+            }
+            else if (!idle.empty()) {
+                f = idle.first();
+                idle.erase(f);
+                index.erase(frames[f].pageNumber);
+            }
+            else {
+                // - Every frame was used in the last 32 references: SoA min-search over their current registers
+                //   (non-zero registers all have a different top bit, so the minimum is unique)
+                unsigned int current[window];
+                for (int k = 0; k < window; k++) {
+                    int g = recent[k];
+                    int used = t - window + ((k - t % window + window) % window);
+                    current[k] = (g >= 0 && lastUse[g] == used) ? (frames[g].age >> (t - used)) : UINT_MAX;
+                }
+                unsigned int best = UINT_MAX;
+                for (int k = 0; k < window; k++) {
+                    best = min(best, current[k]);
+                }
+                int k = 0;
+                while (current[k] != best) {
+                    k++;
+                }
+                f = recent[k];
+                index.erase(frames[f].pageNumber);
+            }
+
+            frames[f].pageNumber = ref;
+            frames[f].age = (1u << 31);
+            index.insert(ref, f);
+        }
+
+        lastUse[f] = t;
+        recent[slot] = f;
+        t++;
+        return fault;
+    }
+};
+
+// Simulate Aging Fast Function: returns the same number of page faults as simulateAging, using AgingPolicy
+// - Reads the trace through forEachReference, so it runs on an in-memory or a memory-mapped trace
+template <class Trace>
+int simulateAgingFast(const Trace& references, int numFrames) {
+    AgingPolicy policy(numFrames);
+    return runPolicy(references, policy);
+}
+
+// simulateLRU Function: Direct LRU simulation (recency list + page index), used to validate lruFaultCurve
+int simulateLRU(const vector<int>& references, int numFrames) {
+    list<int> recency;   // most recently used page at the front
+    unordered_map<int, list<int>::iterator> where;
+    int pageFaults = 0;
+
+    for (int i = 0; i < (int)references.size(); i++) {
+        int ref = references[i];
+        auto it = where.find(ref);
+        if (it != where.end()) {
+            recency.splice(recency.begin(), recency, it->second);
+            continue;
+        }
+        pageFaults++;
+        if ((int)recency.size() == numFrames) {
+            where.erase(recency.back());
+            recency.pop_back();
+        }
+        recency.push_front(ref);
+        where[ref] = recency.begin();
+    }
+    return pageFaults;
+}
+
+// FenwickTree Structure: prefix sums over positions 0..n-1 with O(log n) point updates and queries
+struct FenwickTree {
+    vector<int> tree;
+
+    explicit FenwickTree(int n) : tree(n + 1, 0) {}
+
+    void add(int pos, int delta) {
+        for (int i = pos + 1; i < (int)tree.size(); i += i & -i) {
+            tree[i] += delta;
+        }
+    }
+
+    // prefix Function: sum of positions 0..pos (0 when pos < 0)
+    int prefix(int pos) const {
+        int sum = 0;
+        for (int i = pos + 1; i > 0; i -= i & -i) {
+            sum += tree[i];
+        }
+        return sum;
+    }
+};
+
+// lruFaultCurve Function: LRU page faults for every frame count from 1 to maxFrames in a single pass (Mattson et al.)
+// - LRU is a stack algorithm: a reference hits with F frames exactly when its stack (reuse) distance is <= F,
+//   the stack distance being the number of distinct pages used since the previous reference to the same page, plus one
+// - A Fenwick tree over trace positions marks only the latest reference to each page, so the stack distance of
+//   reference i with previous use p is the number of marks in (p, i), plus one - O(log N) per reference
+// - curve[F] = first references + references with a stack distance greater than F
+template <class Trace>
+vector<int> lruFaultCurve(const Trace& references, int maxFrames) {
+    int n = traceSize(references);
+    FenwickTree marks(n);
+    unordered_map<int, int> lastPos;
+    lastPos.reserve(1024);
+    vector<int> hitsAtDistance(maxFrames + 1, 0);
+
+    int i = 0;
+    forEachReference(references, [&](int ref) {
+        auto it = lastPos.find(ref);
+        if (it == lastPos.end()) {
+            lastPos.emplace(ref, i);
+        } else {
+            int p = it->second;
+            int distance = marks.prefix(i - 1) - marks.prefix(p) + 1;
+            if (distance <= maxFrames) {
+                hitsAtDistance[distance]++;
+            }
+            marks.add(p, -1);
+            it->second = i;
+        }
+        marks.add(i, 1);
+        i++;
+    });
+
+    // - Faults with F frames = all references minus those whose stack distance is at most F
+    vector<int> curve(maxFrames + 1, 0);
+    int hits = 0;
+    for (int frames = 1; frames <= maxFrames; frames++) {
+        hits += hitsAtDistance[frames];
+        curve[frames] = n - hits;
+    }
+    curve[0] = n;
+    return curve;
+}
+
+// ClockPolicy Structure: CLOCK (second chance) - frames form a circle, "age" of each Frame holds its reference bit
+// - A hit only sets the bit; on a fault the hand clears set bits until it finds a clear one to replace
+// - Amortized O(1) per reference, every bit cleared was set by an earlier reference
+struct ClockPolicy {
+    int numFrames;
+    vector<Frame> frames;
+    PageIndex index;
+    int hand = 0;
+
+    explicit ClockPolicy(int numFrames) : numFrames(numFrames), index(numFrames) {
+        frames.reserve(numFrames);
+    }
+
+    bool access(int page) {
+        int f = index.find(page);
+        if (f != -1) {
+            frames[f].age = 1;
+            return false;
+        }
+        if ((int)frames.size() < numFrames) {
+            frames.push_back(Frame());
+            f = frames.size() - 1;
+        } else {
+            while (frames[hand].age != 0) {
+                frames[hand].age = 0;
+                hand = (hand + 1) % numFrames;
+            }
+            f = hand;
+            hand = (hand + 1) % numFrames;
+            index.erase(frames[f].pageNumber);
+        }
+        frames[f].pageNumber = page;
+        frames[f].age = 1;
+        index.insert(page, f);
+        return true;
+    }
+};
+
+// WSClockPolicy Structure: WSClock - CLOCK over the frames plus the working set window "tau" (in references)
+// - The hand clears set reference bits and stamps those frames with the current virtual time
+// - The first frame with a clear bit that is older than tau (outside the working set) is replaced
+// - If a whole turn finds none, the oldest frame seen with a clear bit is replaced
+// - The trace has no writes, so every page is clean and no write-back is ever scheduled
+struct WSClockPolicy {
+    int numFrames;
+    int tau;
+    vector<Frame> frames;   // "age" holds the reference bit
+    vector<int> lastUse;
+    PageIndex index;
+    int hand = 0;
+    int now = 0;
+
+    WSClockPolicy(int numFrames, int tau) : numFrames(numFrames), tau(tau), lastUse(numFrames), index(numFrames) {
+        frames.reserve(numFrames);
+    }
+
+    bool access(int page) {
+        now++;
+        int f = index.find(page);
+        if (f != -1) {
+            frames[f].age = 1;
+            return false;
+        }
+        if ((int)frames.size() < numFrames) {
+            frames.push_back(Frame());
+            f = frames.size() - 1;
+        } else {
+            int oldest = -1;
+            for (int scanned = 0; scanned < 2 * numFrames; scanned++) {
+                int j = hand;
+                hand = (hand + 1) % numFrames;
+                if (frames[j].age != 0) {
+                    frames[j].age = 0;
+                    lastUse[j] = now;
+                    continue;
+                }
+                if (now - lastUse[j] > tau) {
+                    f = j;
+                    break;
+                }
+                if (oldest == -1 || lastUse[j] < lastUse[oldest]) {
+                    oldest = j;
+                }
+                if (scanned >= numFrames && oldest != -1) {
+                    break;
+                }
+            }
+            if (f == -1) {
+                f = oldest;
+            }
+            index.erase(frames[f].pageNumber);
+        }
+        frames[f].pageNumber = page;
+        frames[f].age = 1;
+        lastUse[f] = now;
+        index.insert(page, f);
+        return true;
+    }
+};
+
+// ARCPolicy Structure: Adaptive Replacement Cache (Megiddo and Modha)
+// - T1 holds pages seen once recently, T2 pages seen at least twice; B1 and B2 remember pages evicted from them
+// - A hit in B1 grows the target size "p" of T1, a hit in B2 shrinks it, so the split follows the workload
+// - Lists are std::list with an index to each node, so every step is O(1)
+struct ARCPolicy {
+    enum Where { T1, T2, B1, B2 };
+    struct Entry {
+        Where where;
+        list<int>::iterator it;
+    };
+
+    int c;
+    int p = 0;
+    list<int> lists[4];     // most recent at the front
+    unordered_map<int, Entry> dir;
+
+    explicit ARCPolicy(int numFrames) : c(numFrames) {
+        dir.reserve(numFrames * 4);
+    }
+
+    int size(Where w) const { return lists[w].size(); }
+
+    void moveTo(Entry& e, Where to) {
+        lists[to].splice(lists[to].begin(), lists[e.where], e.it);
+        e.where = to;
+        e.it = lists[to].begin();
+    }
+
+    void dropLRU(Where w) {
+        dir.erase(lists[w].back());
+        lists[w].pop_back();
+    }
+
+    // replace Function: evicts the LRU page of T1 or T2 into its ghost list
+    void replace(bool inB2) {
+        if (size(T1) + size(T2) < c) {
+            return;
+        }
+        if (size(T1) > 0 && (size(T1) > p || (inB2 && size(T1) == p))) {
+            moveTo(dir[lists[T1].back()], B1);
+        } else {
+            moveTo(dir[lists[T2].back()], B2);
+        }
+    }
+
+    bool access(int page) {
+        auto found = dir.find(page);
+        if (found != dir.end()) {
+            Entry& e = found->second;
+            if (e.where == T1 || e.where == T2) {
+                moveTo(e, T2);
+                return false;
+            }
+            if (e.where == B1) {
+                p = min(c, p + max(size(B2) / size(B1), 1));
+                replace(false);
+            } else {
+                p = max(0, p - max(size(B1) / size(B2), 1));
+                replace(true);
+            }
+            moveTo(dir[page], T2);
+            return true;
+        }
+
+        int l1 = size(T1) + size(B1);
+        int total = l1 + size(T2) + size(B2);
+        if (l1 == c) {
+            if (size(T1) < c) {
+                dropLRU(B1);
+                replace(false);
+            } else {
+                dropLRU(T1);
+            }
+        } else if (total >= c) {
+            if (total == 2 * c) {
+                dropLRU(B2);
+            }
+            replace(false);
+        }
+        lists[T1].push_front(page);
+        dir[page] = Entry{T1, lists[T1].begin()};
+        return true;
+    }
+};
+
+// nextUseIndex Function: for every reference, the position of the next reference to the same page (INT_MAX if none)
+// - One backward pass with a hash map, done once per trace and shared by every OPT simulation
+vector<int> nextUseIndex(const vector<int>& references) {
+    vector<int> next(references.size());
+    unordered_map<int, int> seen;
+    for (int i = (int)references.size() - 1; i >= 0; i--) {
+        auto it = seen.find(references[i]);
+        next[i] = (it == seen.end()) ? INT_MAX : it->second;
+        seen[references[i]] = i;
+    }
+    return next;
+}
+
+// OPTPolicy Structure: Belady's optimal replacement - evict the page whose next use is furthest in the future
+// - Next uses come from the precomputed nextUseIndex, so no forward scan of the trace is needed
+// - Resident frames are kept in a set ordered by next use, the victim is its last element: O(log frames)
+struct OPTPolicy {
+    int numFrames;
+    const vector<int>& nextUse;
+    vector<Frame> frames;
+    vector<int> frameNext;      // next use of the page in each frame
+    set<pair<int, int>> byNext; // (next use, frame)
+    PageIndex index;
+    int t = 0;
+
+    OPTPolicy(int numFrames, const vector<int>& nextUse) : numFrames(numFrames), nextUse(nextUse), index(numFrames) {
+        frames.reserve(numFrames);
+        frameNext.reserve(numFrames);
+    }
+
+    bool access(int page) {
+        int f = index.find(page);
+        bool fault = f == -1;
+        if (f != -1) {
+            byNext.erase(make_pair(frameNext[f], f));
+        } else if ((int)frames.size() < numFrames) {
+            frames.push_back(Frame());
+            frameNext.push_back(0);
+            f = frames.size() - 1;
+        } else {
+            auto victim = prev(byNext.end());
+            f = victim->second;
+            byNext.erase(victim);
+            index.erase(frames[f].pageNumber);
+        }
+        if (fault) {
+            frames[f].pageNumber = page;
+            index.insert(page, f);
+        }
+        frameNext[f] = nextUse[t];
+        byNext.insert(make_pair(frameNext[f], f));
+        t++;
+        return fault;
+    }
+};
+
+// simulatePolicy Function: runs the named policy over the trace and returns its page faults
+// - "lruCurve" and "nextUse" are the shared per-trace precomputations of the LRU and OPT columns
+template <class Trace>
+int simulatePolicy(const string& name, const Trace& references, int numFrames, int tau,
+                   const vector<int>& lruCurve, const vector<int>& nextUse) {
+    if (name == "aging") {
+        return simulateAgingFast(references, numFrames);
+    }
+    if (name == "lru") {
+        return lruCurve[numFrames];
+    }
+    if (name == "clock") {
+        ClockPolicy policy(numFrames);
+        return runPolicy(references, policy);
+    }
+    if (name == "wsclock") {
+        WSClockPolicy policy(numFrames, tau);
+        return runPolicy(references, policy);
+    }
+    if (name == "arc") {
+        ARCPolicy policy(numFrames);
+        return runPolicy(references, policy);
+    }
+    OPTPolicy policy(numFrames, nextUse);
+    return runPolicy(references, policy);
+}
+
 // readReferences Function: reads a sequence of page references and stores them into a vector
 vector<int> readReferences(const string& filename) {
     vector<int> references;
@@ -81,14 +939,670 @@ vector<int> readReferences(const string& filename) {
     return references;
 }
 
+// frameSchedule Function: builds the list of frame counts to simulate
+// - By default every count from 1 to maxFrames; with "step" every step-th count (maxFrames is always included)
+// - With "logPoints", about that many log-spaced counts, which is enough to see the shape of the fault curve
+// - Empty when maxFrames is below 1, so the caller prints only its header, as the original loop did
+vector<int> frameSchedule(int maxFrames, int step, int logPoints) {
+    vector<int> counts;
+    if (maxFrames < 1) {
+        return counts;
+    }
+    if (logPoints > 1) {
+        for (int k = 0; k < logPoints; k++) {
+            int frames = (int)llround(pow((double)maxFrames, (double)k / (logPoints - 1)));
+            if (counts.empty() || frames > counts.back()) {
+                counts.push_back(frames);
+            }
+        }
+        return counts;
+    }
+    for (int frames = 1; frames <= maxFrames; frames += step) {
+        counts.push_back(frames);
+    }
+    if (counts.empty() || counts.back() != maxFrames) {
+        counts.push_back(maxFrames);
+    }
+    return counts;
+}
+
+// sweepFrames Function: Parallel sweep engine - runs "simulate(frames)" for every frame count on "numThreads" threads
+// - The counts are only passed through, so a caller can also sweep other job numbers (see runComparison)
+// - Workers take the next frame count from a shared counter, so expensive counts do not hold up a fixed partition
+// - The simulations only read the shared trace captured by "simulate", nothing is copied per thread
+// - "emit(frames, faults)" is called on the calling thread in frame-count order, as soon as the next result is ready;
+//   returning false from it stops the sweep
+template <class Simulate, class Emit>
+void sweepFrames(const vector<int>& frameCounts, int numThreads, Simulate simulate, Emit emit) {
+    int n = frameCounts.size();
+    vector<int> faults(n);
+    vector<bool> done(n, false);
+    atomic<int> next(0);
+    atomic<bool> stop(false);
+    mutex doneMtx;
+    condition_variable ready;
+
+    vector<thread> workers;
+    for (int w = 0; w < max(1, min(numThreads, n)); w++) {
+        workers.push_back(thread([&] {
+            int i;
+            while (!stop && (i = next++) < n) {
+                int result = simulate(frameCounts[i]);
+                lock_guard<mutex> lock(doneMtx);
+                faults[i] = result;
+                done[i] = true;
+                ready.notify_all();
+            }
+        }));
+    }
+
+    for (int i = 0; i < n; i++) {
+        int result;
+        {
+            unique_lock<mutex> lock(doneMtx);
+            ready.wait(lock, [&] { return done[i]; });
+            result = faults[i];
+        }
+        if (!emit(frameCounts[i], result)) {
+            stop = true;
+            break;
+        }
+    }
+
+    for (int w = 0; w < (int)workers.size(); w++) {
+        workers[w].join();
+    }
+}
+
+// SweepOptions Structure: command line settings of the frame-count sweep
+struct SweepOptions {
+    bool useReference = false;   // --reference: original simulateAging instead of simulateAgingFast
+    bool useLRU = false;         // --lru: exact LRU curve from lruFaultCurve instead of the aging approximation
+    bool validate = false;       // --validate: check against simulateAging (or simulateLRU with --lru)
+    int numThreads = max(1u, thread::hardware_concurrency());   // --threads N
+    int step = 1;                // --step S: every S-th frame count
+    int logPoints = 0;           // --log-points K: about K log-spaced frame counts
+    bool compare = false;        // --compare: one table of fault rates for several policies
+    vector<string> policies = {"aging", "lru", "clock", "wsclock", "arc", "opt"};   // --policies a,b,...
+    int tau = 1000;              // --tau N: WSClock working set window, in references
+};
+
+// runComparison Function: prints one table of faults per 1000 references, one column per policy
+// - Every (frame count, policy) pair is a separate job of the parallel sweep; rows are printed in order
+// - The LRU curve and the OPT next-use index are computed once per trace, before the sweep
+template <class Trace>
+int runComparison(const Trace& references, int maxFrames, const SweepOptions& opts) {
+    vector<int> frameCounts = frameSchedule(maxFrames, opts.step, opts.logPoints);
+    int numPolicies = opts.policies.size();
+
+    vector<int> lruCurve, nextUse;
+    for (const string& name : opts.policies) {
+        if (name == "lru" && lruCurve.empty() && !frameCounts.empty()) {
+            lruCurve = lruFaultCurve(references, maxFrames);
+        }
+        if (name == "opt" && nextUse.empty()) {
+            vector<int> decoded;
+            decoded.reserve(traceSize(references));
+            forEachReference(references, [&](int page) { decoded.push_back(page); });
+            nextUse = nextUseIndex(decoded);
+        }
+    }
+
+    cout << "\nFaults per 1000 references\n";
+    cout << "Frames";
+    for (const string& name : opts.policies) {
+        cout << "\t" << name;
+    }
+    cout << "\n";
+    cout << string(8 * (numPolicies + 1), '-') << "\n";
+
+    vector<int> jobs(frameCounts.size() * numPolicies);
+    for (int j = 0; j < (int)jobs.size(); j++) {
+        jobs[j] = j;
+    }
+    auto simulate = [&](int job) {
+        return simulatePolicy(opts.policies[job % numPolicies], references, frameCounts[job / numPolicies],
+                              opts.tau, lruCurve, nextUse);
+    };
+    auto emit = [&](int job, int faults) {
+        if (job % numPolicies == 0) {
+            cout << frameCounts[job / numPolicies];
+        }
+        cout << "\t" << fixed << setprecision(2) << (double)faults / traceSize(references) * 1000;
+        if (job % numPolicies == numPolicies - 1) {
+            cout << endl;
+        }
+        return true;
+    };
+    sweepFrames(jobs, opts.numThreads, simulate, emit);
+    return 0;
+}
+
+// runSweep Function: prints the faults per 1000 references for the scheduled frame counts of one trace
+// - "references" is either the in-memory vector or a MappedTrace; the reference simulators get a decoded copy
+template <class Trace>
+int runSweep(const Trace& references, int maxFrames, const SweepOptions& opts) {
+    // - The original simulators take a vector, decoded only when they are used
+    vector<int> decoded;
+    if (opts.useReference || opts.validate) {
+        forEachReference(references, [&](int page) { decoded.push_back(page); });
+    }
+
+    cout << "\nFrames\tFaults per 1000 references\n";
+    cout << "--------------------------------------\n";
+
+    // - The LRU curve for every frame count comes out of one pass, the sweep then only looks it up
+    vector<int> frameCounts = frameSchedule(maxFrames, opts.step, opts.logPoints);
+    vector<int> lruCurve;
+    if (opts.useLRU && !frameCounts.empty()) {
+        lruCurve = lruFaultCurve(references, maxFrames);
+    }
+
+    // - In validate mode a mismatch is reported as a negative fault count
+    bool mismatch = false;
+    auto simulate = [&](int frames) {
+        if (opts.useLRU) {
+            return (opts.validate && lruCurve[frames] != simulateLRU(decoded, frames)) ? -1 : lruCurve[frames];
+        }
+        int faults = opts.useReference ? simulateAging(decoded, frames) : simulateAgingFast(references, frames);
+        if (opts.validate && faults != simulateAging(decoded, frames)) {
+            return -1;
+        }
+        return faults;
+    };
+    auto emit = [&](int frames, int faults) {
+        if (faults < 0 && opts.useLRU) {
+            cout << "MISMATCH at " << frames << " frames: stack distance curve gives " << lruCurve[frames]
+                 << ", LRU simulation gives " << simulateLRU(decoded, frames) << endl;
+            mismatch = true;
+            return false;
+        }
+        if (faults < 0) {
+            cout << "MISMATCH at " << frames << " frames: fast simulator gives " << simulateAgingFast(references, frames)
+                 << ", reference gives " << simulateAging(decoded, frames) << endl;
+            mismatch = true;
+            return false;
+        }
+        double faultsPer1000 = (double)faults / traceSize(references) * 1000;
+
+        cout << frames << "\t"
+             << fixed << setprecision(2)
+             << faultsPer1000 << endl;
+        return true;
+    };
+
+    sweepFrames(frameCounts, opts.numThreads, simulate, emit);
+
+    return mismatch ? 1 : 0;
+}
+
+// Multi-process trace ("--mp FILE"): one "pid address r|w" record per line
+// - The address is hexadecimal, with or without "0x"; "w" or "W" marks a write, anything else is a read
+// - Lines that do not start with a pid are skipped, so comments and blank lines are allowed
+
+// MemoryRef Structure: one loaded record
+// - "page" numbers every (process, virtual page) pair of the trace densely, in order of first use
+struct MemoryRef {
+    int proc;
+    int page;
+    bool write;
+};
+
+// MemoryTrace Structure: loaded records plus what the dense numbers stand for
+struct MemoryTrace {
+    vector<MemoryRef> refs;
+    vector<long long> pids;       // pid of every dense process number
+    vector<int> pageOwner;        // process of every dense page
+    vector<uint64_t> pageVpn;     // virtual page number of every dense page
+    long long skipped = 0;        // lines that were not a record
+};
+
+// loadMemoryTrace Function: maps the text trace and parses it in one pass
+// - Each process keeps a hash map from virtual page to dense page, so the simulator itself never hashes
+bool loadMemoryTrace(const string& filename, uint64_t pageSize, MemoryTrace& trace) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        cout << "Error opening file.\n";
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return true;
+    }
+    void* mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        cout << "Error mapping file.\n";
+        return false;
+    }
+    madvise(mapping, st.st_size, MADV_SEQUENTIAL);
+    const char* p = (const char*)mapping;
+    const char* end = p + st.st_size;
+
+    unordered_map<long long, int> procOf;
+    vector<unordered_map<uint64_t, int>> pageOf;
+    long long lastPid = -1;
+    int lastProc = -1, lastPageProc = -1, lastPage = -1;
+    uint64_t lastVpn = 0;
+
+    auto hexDigit = [](char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    };
+
+    while (p < end) {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) {
+            p++;
+        }
+        if (p == end) {
+            break;
+        }
+        const char* lineStart = p;
+
+        // - pid (decimal), then the address (hex), then the access type
+        long long pid = 0;
+        while (p < end && *p >= '0' && *p <= '9') {
+            pid = pid * 10 + (*p++ - '0');
+        }
+        bool ok = p > lineStart && p < end && (*p == ' ' || *p == '\t');
+        while (p < end && (*p == ' ' || *p == '\t')) {
+            p++;
+        }
+        if (p + 1 < end && p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) {
+            p += 2;
+        }
+        uint64_t address = 0;
+        const char* digits = p;
+        int d;
+        while (p < end && (d = hexDigit(*p)) >= 0) {
+            address = (address << 4) | d;
+            p++;
+        }
+        ok = ok && p > digits;
+        while (p < end && (*p == ' ' || *p == '\t')) {
+            p++;
+        }
+        bool write = p < end && (*p == 'w' || *p == 'W');
+        while (p < end && *p != '\n') {
+            p++;
+        }
+        if (!ok) {
+            trace.skipped++;
+            continue;
+        }
+
+        if (pid != lastPid) {
+            auto it = procOf.find(pid);
+            if (it == procOf.end()) {
+                it = procOf.emplace(pid, (int)trace.pids.size()).first;
+                trace.pids.push_back(pid);
+                pageOf.emplace_back();
+            }
+            lastPid = pid;
+            lastProc = it->second;
+        }
+        uint64_t vpn = address / pageSize;
+        // - Consecutive references usually hit the same page, which skips the hash lookup
+        if (vpn != lastVpn || lastProc != lastPageProc) {
+            auto it = pageOf[lastProc].find(vpn);
+            if (it == pageOf[lastProc].end()) {
+                it = pageOf[lastProc].emplace(vpn, (int)trace.pageOwner.size()).first;
+                trace.pageOwner.push_back(lastProc);
+                trace.pageVpn.push_back(vpn);
+            }
+            lastVpn = vpn;
+            lastPageProc = lastProc;
+            lastPage = it->second;
+        }
+        trace.refs.push_back({lastProc, lastPage, write});
+    }
+
+    munmap(mapping, st.st_size);
+    return true;
+}
+
+// TLB Structure: set-associative TLB with LRU replacement inside each set
+// - The set comes from the low bits of the virtual page number, as in hardware
+// - Entries are tagged with the dense page, which includes the process (like an ASID), so switching
+//   between processes needs no flush
+// - An entry is 16 bytes, so a 4-way set is one cache line
+struct TLB {
+    struct Entry {
+        int page;            // dense page, -1 for an invalid entry
+        int frame;
+        uint64_t lastUse;
+    };
+    int ways;
+    vector<Entry> entries;   // set s occupies [s * ways, (s + 1) * ways)
+    uint64_t now = 0;
+
+    TLB(int numSets, int numWays) : ways(numWays), entries((size_t)numSets * numWays, Entry{-1, 0, 0}) {}
+
+    // lookup Function: frame of "page" on a hit, -1 on a miss
+    // - All ways are compared without an early exit, which compiles to conditional moves; which way hits
+    //   is random, so a branch per way would mispredict on most references
+    int lookup(int page, int set) {
+        Entry* e = &entries[(size_t)set * ways];
+        int hit = -1;
+        for (int w = 0; w < ways; w++) {
+            hit = e[w].page == page ? w : hit;
+        }
+        if (hit < 0) {
+            return -1;
+        }
+        e[hit].lastUse = ++now;
+        return e[hit].frame;
+    }
+
+    // insert Function: fills an invalid way of the set, or replaces its least recently used entry
+    void insert(int page, int set, int frame) {
+        Entry* e = &entries[(size_t)set * ways];
+        int victim = 0;
+        for (int w = 0; w < ways; w++) {
+            if (e[w].page == -1) {
+                victim = w;
+                break;
+            }
+            if (e[w].lastUse < e[victim].lastUse) {
+                victim = w;
+            }
+        }
+        e[victim] = Entry{page, frame, ++now};
+    }
+
+    // invalidate Function: drops the entry of an evicted page (TLB shootdown)
+    void invalidate(int page, int set) {
+        Entry* e = &entries[(size_t)set * ways];
+        for (int w = 0; w < ways; w++) {
+            if (e[w].page == page) {
+                e[w].page = -1;
+                return;
+            }
+        }
+    }
+};
+
+// MultiProcessOptions Structure: command line settings of the multi-process simulator
+struct MultiProcessOptions {
+    int frames = 256;        // --frames N: physical frames
+    int tlbSets = 16;        // --tlb-sets S
+    int tlbWays = 4;         // --tlb-ways W
+    bool partition = false;  // --partition: an equal share of the frames per process instead of one global pool
+    int wsWindow = 10000;    // --ws-window T: working set window, in references
+    int wsInterval = 0;      // --ws-interval I: sample the working set every I references (0: 20 samples)
+};
+
+// simulateMultiProcess Function: TLB, page tables and a CLOCK frame pool over a multi-process trace
+// - Page tables are flat: the dense page numbering of the loader makes a page table walk one array access
+// - Every access sets the frame's reference bit, a write also its dirty bit; evicting a dirty page is a write-back
+// - With "partition" process p only ever replaces frames of its own range, otherwise any frame can be the victim
+// - The working set of a process is the set of its pages referenced in the last "wsWindow" references of the
+//   whole trace; it is kept incrementally from each page's last reference time
+void simulateMultiProcess(const MemoryTrace& trace, const MultiProcessOptions& opts) {
+    const vector<MemoryRef>& refs = trace.refs;
+    long long n = refs.size();
+    int numProcs = trace.pids.size();
+    int numPages = trace.pageOwner.size();
+
+    // - Everything the loop needs about a page sits in one 16-byte entry: its page table entry, its TLB set
+    //   and its last reference time
+    struct PageState {
+        long long lastRef;
+        int frame;   // -1 when not resident
+        int set;
+    };
+    vector<PageState> pages(numPages);
+    for (int page = 0; page < numPages; page++) {
+        pages[page] = PageState{LLONG_MIN / 2, -1, (int)(trace.pageVpn[page] % opts.tlbSets)};
+    }
+
+    // - Frame ranges: one range for the global pool, or one per process
+    struct Pool {
+        int start, end, used, hand;
+    };
+    vector<Pool> pools;
+    if (opts.partition) {
+        for (int p = 0; p < numProcs; p++) {
+            int start = (long long)opts.frames * p / numProcs;
+            int end = (long long)opts.frames * (p + 1) / numProcs;
+            pools.push_back({start, end, 0, start});
+        }
+    } else {
+        pools.push_back({0, opts.frames, 0, 0});
+    }
+
+    TLB tlb(opts.tlbSets, opts.tlbWays);
+    vector<int> framePage(opts.frames, -1);
+    vector<unsigned char> referenced(opts.frames, 0), dirty(opts.frames, 0);
+    vector<long long> procRefs(numProcs, 0), procFaults(numProcs, 0), procWriteBacks(numProcs, 0);
+    vector<int> wss(numProcs, 0), maxWss(numProcs, 0);
+    vector<double> sumWss(numProcs, 0);
+    vector<pair<long long, long long>> samples;
+    long long tlbHits = 0, faults = 0, writeBacks = 0, totalWss = 0;
+    long long interval = opts.wsInterval > 0 ? opts.wsInterval : max(1LL, n / 20);
+    long long window = opts.wsWindow;
+    long long nextSample = interval;
+
+    auto start = chrono::steady_clock::now();
+    for (long long t = 0; t < n; t++) {
+        const MemoryRef& ref = refs[t];
+        int page = ref.page;
+        PageState& state = pages[page];
+        int set = state.set;
+        procRefs[ref.proc]++;
+
+        // - TLB, then the page table, then a fault
+        int frame = tlb.lookup(page, set);
+        if (frame >= 0) {
+            tlbHits++;
+        } else {
+            frame = state.frame;
+            if (frame < 0) {
+                faults++;
+                procFaults[ref.proc]++;
+                Pool& pool = pools[opts.partition ? ref.proc : 0];
+                if (pool.start + pool.used < pool.end) {
+                    frame = pool.start + pool.used++;
+                } else {
+                    while (referenced[pool.hand]) {
+                        referenced[pool.hand] = 0;
+                        if (++pool.hand == pool.end) {
+                            pool.hand = pool.start;
+                        }
+                    }
+                    frame = pool.hand;
+                    if (++pool.hand == pool.end) {
+                        pool.hand = pool.start;
+                    }
+                    int victim = framePage[frame];
+                    if (dirty[frame]) {
+                        writeBacks++;
+                        procWriteBacks[trace.pageOwner[victim]]++;
+                    }
+                    pages[victim].frame = -1;
+                    tlb.invalidate(victim, pages[victim].set);
+                }
+                framePage[frame] = page;
+                state.frame = frame;
+                dirty[frame] = 0;
+            }
+            tlb.insert(page, set, frame);
+        }
+        referenced[frame] = 1;
+        if (ref.write) {
+            dirty[frame] = 1;
+        }
+
+        // - Working set: the reference leaving the window drops its page unless that page was used again since
+        if (t >= window) {
+            const MemoryRef& old = refs[t - window];
+            if (pages[old.page].lastRef == t - window) {
+                wss[old.proc]--;
+                totalWss--;
+            }
+        }
+        if (state.lastRef <= t - window) {
+            wss[ref.proc]++;
+            totalWss++;
+        }
+        state.lastRef = t;
+
+        if (t + 1 == nextSample) {
+            nextSample += interval;
+            samples.push_back({t + 1, totalWss});
+            for (int p = 0; p < numProcs; p++) {
+                sumWss[p] += wss[p];
+                maxWss[p] = max(maxWss[p], wss[p]);
+            }
+        }
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "\nReferences: " << n << "  Processes: " << numProcs << "  Pages touched: " << numPages << "\n";
+    if (opts.partition) {
+        cout << "Frames: " << opts.frames << " (partitioned, " << opts.frames / max(1, numProcs) << " per process, CLOCK)\n";
+    } else {
+        cout << "Frames: " << opts.frames << " (global pool, CLOCK)\n";
+    }
+    cout << fixed << setprecision(2);
+    cout << "TLB: " << opts.tlbSets << " sets x " << opts.tlbWays << " ways, hit rate "
+         << 100.0 * tlbHits / max(1LL, n) << "% (" << n - tlbHits << " misses)\n";
+    cout << "Page faults: " << faults << " (" << 1000.0 * faults / max(1LL, n) << " per 1000 references)\n";
+    cout << "Dirty write-backs: " << writeBacks << "\n";
+    cout << "Simulated in " << seconds * 1000 << " ms (" << n / max(seconds, 1e-9) / 1e6 << " M references/s)\n";
+
+    cout << "\nWorking set size (window " << window << " references)\n";
+    cout << "Reference\tPages\n";
+    cout << "--------------------------------------\n";
+    for (const auto& sample : samples) {
+        cout << sample.first << "\t" << sample.second << "\n";
+    }
+
+    cout << "\nPID\tReferences\tFaults\tWrite-backs\tAvg WSS\tMax WSS\n";
+    cout << "--------------------------------------------------------------\n";
+    for (int p = 0; p < numProcs; p++) {
+        cout << trace.pids[p] << "\t" << procRefs[p] << "\t\t" << procFaults[p] << "\t" << procWriteBacks[p] << "\t\t"
+             << (samples.empty() ? 0.0 : sumWss[p] / samples.size()) << "\t" << maxWss[p] << "\n";
+    }
+}
+
 // Main Loop
-int main() {
+// - "--convert TEXT BINARY [--page-size BYTES]" converts a text trace into the binary format and exits
+// - "--mp FILE" runs the multi-process TLB / page table simulator on a "pid address r|w" trace and exits
+// - A binary trace is detected by its header and streamed from a memory mapping; text traces are read into memory
+int main(int argc, char* argv[]) {
+    SweepOptions opts;
+    MultiProcessOptions mpOpts;
+    string convertFrom, convertTo, mpFile;
+    uint32_t pageSize = 4096;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--reference") {
+            opts.useReference = true;
+        } else if (arg == "--validate") {
+            opts.validate = true;
+        } else if (arg == "--lru") {
+            opts.useLRU = true;
+        } else if (arg == "--threads" && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+            opts.numThreads = atoi(argv[++i]);
+        } else if (arg == "--step" && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+            opts.step = atoi(argv[++i]);
+        } else if (arg == "--log-points" && i + 1 < argc && atoi(argv[i + 1]) > 1) {
+            opts.logPoints = atoi(argv[++i]);
+        } else if (arg == "--compare") {
+            opts.compare = true;
+        } else if (arg == "--policies" && i + 1 < argc) {
+            opts.compare = true;
+            opts.policies.clear();
+            string list = argv[++i];
+            size_t start = 0;
+            while (start <= list.size()) {
+                size_t comma = list.find(',', start);
+                if (comma == string::npos) {
+                    comma = list.size();
+                }
+                string name = list.substr(start, comma - start);
+                if (name != "aging" && name != "lru" && name != "clock" && name != "wsclock" &&
+                    name != "arc" && name != "opt") {
+                    cerr << "Unknown policy: " << name << " (aging, lru, clock, wsclock, arc, opt)" << endl;
+                    return 1;
+                }
+                opts.policies.push_back(name);
+                start = comma + 1;
+            }
+        } else if (arg == "--tau" && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+            opts.tau = atoi(argv[++i]);
+        } else if (arg == "--convert" && i + 2 < argc) {
+            convertFrom = argv[++i];
+            convertTo = argv[++i];
+        } else if (arg == "--page-size" && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+            pageSize = atoi(argv[++i]);
+        } else if (arg == "--mp" && i + 1 < argc) {
+            mpFile = argv[++i];
+        } else if (arg == "--frames" && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+            mpOpts.frames = atoi(argv[++i]);
+        } else if (arg == "--tlb-sets" && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+            mpOpts.tlbSets = atoi(argv[++i]);
+        } else if (arg == "--tlb-ways" && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+            mpOpts.tlbWays = atoi(argv[++i]);
+        } else if (arg == "--partition") {
+            mpOpts.partition = true;
+        } else if (arg == "--ws-window" && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+            mpOpts.wsWindow = atoi(argv[++i]);
+        } else if (arg == "--ws-interval" && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+            mpOpts.wsInterval = atoi(argv[++i]);
+        } else {
+            cerr << "Usage: " << argv[0] << " [--reference | --lru] [--validate] [--threads N] [--step S | --log-points K]" << endl;
+            cerr << "       " << argv[0] << " --compare [--policies aging,lru,clock,wsclock,arc,opt] [--tau N] [--threads N] [--step S | --log-points K]" << endl;
+            cerr << "       " << argv[0] << " --convert TEXT_TRACE BINARY_TRACE [--page-size BYTES]" << endl;
+            cerr << "       " << argv[0] << " --mp TRACE [--page-size BYTES] [--frames N] [--partition] [--tlb-sets S] [--tlb-ways W]" << endl;
+            cerr << "       " << string(strlen(argv[0]), ' ') << " [--ws-window T] [--ws-interval I]" << endl;
+            return 1;
+        }
+    }
+
+    if (!mpFile.empty()) {
+        MemoryTrace trace;
+        auto start = chrono::steady_clock::now();
+        if (!loadMemoryTrace(mpFile, pageSize, trace)) {
+            return 1;
+        }
+        if (trace.refs.empty()) {
+            cout << "No references loaded.\n";
+            return 1;
+        }
+        if (mpOpts.partition && mpOpts.frames < (int)trace.pids.size()) {
+            cout << "Partitioning needs at least one frame per process (" << trace.pids.size() << " processes).\n";
+            return 1;
+        }
+        cout << "Loaded " << trace.refs.size() << " references in " << fixed << setprecision(2)
+             << chrono::duration<double>(chrono::steady_clock::now() - start).count() * 1000 << " ms";
+        if (trace.skipped > 0) {
+            cout << " (" << trace.skipped << " lines skipped)";
+        }
+        cout << endl;
+        simulateMultiProcess(trace, mpOpts);
+        return 0;
+    }
+
+    if (!convertFrom.empty()) {
+        return convertTrace(convertFrom, convertTo, pageSize) ? 0 : 1;
+    }
+
     string filename;
     cout << "Enter reference file name: ";
     cin >> filename;
 
-    vector<int> references = readReferences(filename);
-    if (references.empty()) {
+    MappedTrace mapped;
+    bool binary = mapped.open(filename);
+    vector<int> references;
+    if (!binary) {
+        references = readReferences(filename);
+    }
+    if (binary ? mapped.size() == 0 : references.empty()) {
         cout << "No references loaded.\n";
         return 1;
     }
@@ -97,17 +1611,8 @@ int main() {
     cout << "Enter maximum number of frames to test: ";
     cin >> maxFrames;
 
-    cout << "\nFrames\tFaults per 1000 references\n";
-    cout << "--------------------------------------\n";
-
-    for (int frames = 1; frames <= maxFrames; frames++) {
-        int faults = simulateAging(references, frames);
-        double faultsPer1000 = (double)faults / references.size() * 1000;
-
-        cout << frames << "\t"
-             << fixed << setprecision(2)
-             << faultsPer1000 << endl;
+    if (opts.compare) {
+        return binary ? runComparison(mapped, maxFrames, opts) : runComparison(references, maxFrames, opts);
     }
-
-    return 0;
-}
\ No newline at end of file
+    return binary ? runSweep(mapped, maxFrames, opts) : runSweep(references, maxFrames, opts);
+}
@@ -4,16 +4,202 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
+#include <cmath>
+#include <charconv>
+#include <cstdio>
+#include <iomanip>
 #include <thread>
 #include <mutex>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <condition_variable>
+#include <memory>
+#include <algorithm>
+#include <string_view>
+#include <cstring>
+#include <cstdint>
+#include <chrono>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_SIMD 1
+#endif
 
 using namespace std;
 
 mutex mtx;
 
 
+// WordMap Type: word -> count, with a transparent comparator so it can be searched with a string_view
+typedef map<string, int, less<>> WordMap;
+
 // Each individual thread stores its result here
-vector<map<string, int>> results;
+vector<WordMap> results;
+
+// Options Structure: holds the run settings that can be given on the command line
+struct Options {
+    bool useMmap = false;   // --mmap: map the input file and split it into byte ranges instead of reading lines
+    string backend = "map"; // --backend map|hash: per-thread std::map merged serially, or hash tables merged in parallel
+    bool sorted = false;    // --sorted: sort the final counts by word (always the case for the map backend)
+    string tokenizer = "auto"; // --tokenizer auto|scalar|sse2|avx2: block classifier used by the byte-range pipeline
+    string benchFile;       // --bench-tokenizer FILE: measure tokenizer throughput on FILE and exit
+    size_t chunkSize = 1 << 20; // --chunk-size BYTES[K|M]: size of the work units handed to the thread pool
+    int topK = 0;           // --topk K: bounded-memory streaming mode that only reports the K most frequent words
+    double epsilon = 0.0001; // --epsilon E: top-K counts overestimate by at most E * (total words)
+    double reportEvery = 0; // --report-every SECONDS: print the running top-K periodically while streaming
+    string input;           // -i, --input FILE: input file ("-" for stdin); prompted for when missing
+    int threads = 0;        // -t, --threads N: number of threads; prompted for when missing
+    string format = "text"; // --format text|csv|json|binary: format of the final counts
+    bool quiet = false;     // -q, --quiet: skip the per-thread word counts and the worker report
+};
+
+// MappedFile Structure: a read-only memory mapping of the whole input file
+struct MappedFile {
+    const char* data = nullptr;
+    size_t size = 0;
+};
+
+// OutputWriter Class: One large buffer in front of stdout, written with a single fwrite whenever it fills up
+// - Used for all results so large outputs are not slowed down by a flush per line
+class OutputWriter {
+public:
+    explicit OutputWriter(FILE* file, size_t capacity = 1 << 20) : file(file), capacity(capacity) {
+        buffer.reserve(capacity);
+    }
+
+    ~OutputWriter() { flush(); }
+
+    OutputWriter& operator<<(string_view text) {
+        if (buffer.size() + text.size() > capacity) {
+            flush();
+        }
+        buffer.append(text.data(), text.size());
+        return *this;
+    }
+
+    OutputWriter& operator<<(char c) {
+        if (buffer.size() + 1 > capacity) {
+            flush();
+        }
+        buffer.push_back(c);
+        return *this;
+    }
+
+    OutputWriter& operator<<(long long value) {
+        char digits[24];
+        char* end = to_chars(digits, digits + sizeof(digits), value).ptr;
+        return *this << string_view(digits, end - digits);
+    }
+
+    OutputWriter& operator<<(int value) { return *this << (long long)value; }
+
+    // raw Function: Appends "n" bytes as they are, used by the binary format
+    void raw(const void* data, size_t n) {
+        *this << string_view((const char*)data, n);
+    }
+
+    // flush Function: Writes out everything buffered so far
+    void flush() {
+        if (!buffer.empty()) {
+            fwrite(buffer.data(), 1, buffer.size(), file);
+            buffer.clear();
+        }
+        fflush(file);
+    }
+
+private:
+    FILE* file;
+    size_t capacity;
+    string buffer;
+};
+
+// All results are written through this writer
+OutputWriter out(stdout);
+
+// Set from --quiet and --format: whether the per-thread word counts are printed
+bool showSegments = true;
+
+// CountWriter Class: Writes a list of (word, count) results in one of the output formats
+// - text:   "word: count" lines under a title, as the program always printed them
+// - csv:    "word,count" with a header line
+// - json:   {"words": [{"word": ..., "count": ...}, ...], "total": ...}
+// - binary: "WCNT", u32 version, u32 flags (1 = has error column), then records of
+//           u32 length, word bytes, u64 count [, u64 error], ended by a record of length 0 (little-endian)
+// - "error" is only written for the approximate top-K mode
+class CountWriter {
+public:
+    CountWriter(const string& format, bool withError) : format(format), withError(withError) {}
+
+    // begin Function: Writes the title or header that comes before the first entry
+    void begin(const string& title) {
+        if (format == "text") {
+            out << "\n------ " << title << " ------\n";
+        } else if (format == "csv") {
+            out << (withError ? "word,count,error\n" : "word,count\n");
+        } else if (format == "json") {
+            out << "{\"words\": [";
+        } else {
+            uint32_t header[2] = {1, withError ? 1u : 0u};
+            out << "WCNT";
+            out.raw(header, sizeof(header));
+        }
+    }
+
+    // add Function: Writes one entry, words only ever contain lowercase letters so nothing needs escaping
+    void add(string_view word, long long count, long long error = 0) {
+        if (format == "text") {
+            out << word << ": " << count;
+            if (error > 0) {
+                out << " (overestimated by at most " << error << ")";
+            }
+            out << '\n';
+        } else if (format == "csv") {
+            out << word << ',' << count;
+            if (withError) {
+                out << ',' << error;
+            }
+            out << '\n';
+        } else if (format == "json") {
+            out << (first ? "\n" : ",\n") << "  {\"word\": \"" << word << "\", \"count\": " << count;
+            if (withError) {
+                out << ", \"error\": " << error;
+            }
+            out << '}';
+        } else {
+            uint32_t len = word.size();
+            uint64_t values[2] = {(uint64_t)count, (uint64_t)error};
+            out.raw(&len, sizeof(len));
+            out << word;
+            out.raw(values, withError ? 16 : 8);
+        }
+        first = false;
+    }
+
+    // end Function: Closes the list; "total" is the number of words counted, or -1 when not reported
+    void end(long long total = -1) {
+        if (format == "json") {
+            out << "\n]";
+            if (total >= 0) {
+                out << ", \"total\": " << total;
+            }
+            out << "}\n";
+        } else if (format == "binary") {
+            uint32_t len = 0;
+            out.raw(&len, sizeof(len));
+        }
+        out.flush();
+    }
+
+private:
+    string format;
+    bool withError;
+    bool first = true;
+};
 
 // toLower Function: Removes non alphabetical characters and converts letters to lowercase
 string toLower(string word) {
@@ -31,7 +217,7 @@ string toLower(string word) {
 // 2. It then prints the word counts for that segment 
 // 3. It then saves the results in a shared structure so they can later be combined into the final word-frequency output
 void countWords(int id, vector<string> lines) {
-    map<string, int> localCount;
+    WordMap localCount;
 
     for (int i = 0; i < lines.size(); i++) {
         stringstream ss(lines[i]);
@@ -45,12 +231,14 @@ void countWords(int id, vector<string> lines) {
     }
 
     // Mutex Locking: To prevent threads from printing simultaneously
-    mtx.lock();
-    cout << "\n[Thread " << id << "] word counts for segment " << id << ":" << endl;
-    for (auto it = localCount.begin(); it != localCount.end(); it++) {
-        cout << "  " << it->first << ": " << it->second << endl;
+    if (showSegments) {
+        mtx.lock();
+        out << "\n[Thread " << id << "] word counts for segment " << id << ":\n";
+        for (auto it = localCount.begin(); it != localCount.end(); it++) {
+            out << "  " << it->first << ": " << it->second << '\n';
+        }
+        mtx.unlock();
     }
-    mtx.unlock();
 
     
     mtx.lock();
@@ -58,19 +246,1009 @@ void countWords(int id, vector<string> lines) {
     mtx.unlock();
 }
 
-int main() {
-    string filename;
-    int N;
+// isSpace Function: Same whitespace set that "ss >> word" splits on (space, \t, \n, \v, \f, \r)
+inline bool isSpace(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// mapFile Function: Maps the input file read-only into memory so threads can read it without copying it
+bool mapFile(const string& filename, MappedFile& mf) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+
+    mf.size = st.st_size;
+    if (mf.size > 0) {
+        void* p = mmap(nullptr, mf.size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        // - The file is read front to back, so let the kernel read ahead aggressively
+        madvise(p, mf.size, MADV_SEQUENTIAL);
+        mf.data = (const char*)p;
+    }
+
+    // - The mapping stays valid after the descriptor is closed
+    close(fd);
+    return true;
+}
+
+// unmapFile Function: Releases the mapping created by mapFile
+void unmapFile(MappedFile& mf) {
+    if (mf.data != nullptr) {
+        munmap((void*)mf.data, mf.size);
+    }
+    mf.data = nullptr;
+    mf.size = 0;
+}
+
+// splitChunks Function: Splits the mapped data into contiguous chunks of about "chunkSize" bytes
+// - Each cut point is moved forward to the next whitespace character so no word is split between two chunks
+vector<string_view> splitChunks(string_view data, size_t chunkSize) {
+    vector<string_view> chunks;
+    size_t start = 0;
+    while (start < data.size()) {
+        size_t end = min(data.size(), start + chunkSize);
+        while (end < data.size() && !isSpace(data[end])) {
+            end++;
+        }
+        chunks.push_back(data.substr(start, end - start));
+        start = end;
+    }
+    return chunks;
+}
+
+// releaseConsumed Function: Drops the already counted pages of a range from memory
+// - Every word has been copied into the map by then, so the pages are only re-read from the file if touched again
+void releaseConsumed(const char* from, const char* to) {
+    long pageSize = sysconf(_SC_PAGESIZE);
+    uintptr_t first = ((uintptr_t)from + pageSize - 1) / pageSize * pageSize;
+    uintptr_t last = (uintptr_t)to / pageSize * pageSize;
+    if (last > first) {
+        madvise((void*)first, last - first, MADV_DONTNEED);
+    }
+}
+
+// ClassifyFn Type: Tokenizer kernel that classifies "n" bytes of "src" in one pass
+// - lower:     copy of the bytes with the letters lowercased
+// - spaceBits: bit k is set when byte k is whitespace
+// - alphaBits: bit k is set when byte k is a letter (A-Z, a-z, same as isalpha in the default "C" locale)
+typedef void (*ClassifyFn)(const char* src, size_t n, char* lower, uint64_t* spaceBits, uint64_t* alphaBits);
+
+// classifyScalar Function: One byte at a time, used as the fallback and for the tail of the SIMD kernels
+void classifyScalar(const char* src, size_t n, char* lower, uint64_t* spaceBits, uint64_t* alphaBits) {
+    memset(spaceBits, 0, (n + 63) / 64 * 8);
+    memset(alphaBits, 0, (n + 63) / 64 * 8);
+    for (size_t k = 0; k < n; k++) {
+        unsigned char c = src[k];
+        bool alpha = (unsigned char)((c | 0x20) - 'a') < 26;
+        lower[k] = alpha ? (c | 0x20) : c;
+        spaceBits[k / 64] |= (uint64_t)isSpace(c) << (k % 64);
+        alphaBits[k / 64] |= (uint64_t)alpha << (k % 64);
+    }
+}
+
+#ifdef HAVE_X86_SIMD
+// classifySSE2 Function: 16 bytes at a time
+// - Range checks are done with "min(x - lo, hi - lo) == x - lo", SSE2 has no unsigned byte compare
+void classifySSE2(const char* src, size_t n, char* lower, uint64_t* spaceBits, uint64_t* alphaBits) {
+    const __m128i blank = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i ctrlSpan = _mm_set1_epi8('\r' - '\t');
+    const __m128i caseBit = _mm_set1_epi8(0x20);
+    const __m128i a = _mm_set1_epi8('a');
+    const __m128i alphaSpan = _mm_set1_epi8(25);
+
+    size_t k = 0;
+    for (; k + 64 <= n; k += 64) {
+        uint64_t space = 0, alpha = 0;
+        for (int part = 0; part < 4; part++) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(src + k + part * 16));
+            __m128i ctrl = _mm_sub_epi8(v, tab);
+            __m128i isSp = _mm_or_si128(_mm_cmpeq_epi8(v, blank),
+                                        _mm_cmpeq_epi8(_mm_min_epu8(ctrl, ctrlSpan), ctrl));
+            __m128i letter = _mm_sub_epi8(_mm_or_si128(v, caseBit), a);
+            __m128i isAl = _mm_cmpeq_epi8(_mm_min_epu8(letter, alphaSpan), letter);
+            _mm_storeu_si128((__m128i*)(lower + k + part * 16), _mm_or_si128(v, _mm_and_si128(isAl, caseBit)));
+            space |= (uint64_t)(uint16_t)_mm_movemask_epi8(isSp) << (part * 16);
+            alpha |= (uint64_t)(uint16_t)_mm_movemask_epi8(isAl) << (part * 16);
+        }
+        spaceBits[k / 64] = space;
+        alphaBits[k / 64] = alpha;
+    }
+    if (k < n) {
+        classifyScalar(src + k, n - k, lower + k, spaceBits + k / 64, alphaBits + k / 64);
+    }
+}
+
+// classifyAVX2 Function: 32 bytes at a time, same checks as classifySSE2 on 256-bit registers
+__attribute__((target("avx2")))
+void classifyAVX2(const char* src, size_t n, char* lower, uint64_t* spaceBits, uint64_t* alphaBits) {
+    const __m256i blank = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i ctrlSpan = _mm256_set1_epi8('\r' - '\t');
+    const __m256i caseBit = _mm256_set1_epi8(0x20);
+    const __m256i a = _mm256_set1_epi8('a');
+    const __m256i alphaSpan = _mm256_set1_epi8(25);
+
+    size_t k = 0;
+    for (; k + 64 <= n; k += 64) {
+        uint64_t space = 0, alpha = 0;
+        for (int part = 0; part < 2; part++) {
+            __m256i v = _mm256_loadu_si256((const __m256i*)(src + k + part * 32));
+            __m256i ctrl = _mm256_sub_epi8(v, tab);
+            __m256i isSp = _mm256_or_si256(_mm256_cmpeq_epi8(v, blank),
+                                           _mm256_cmpeq_epi8(_mm256_min_epu8(ctrl, ctrlSpan), ctrl));
+            __m256i letter = _mm256_sub_epi8(_mm256_or_si256(v, caseBit), a);
+            __m256i isAl = _mm256_cmpeq_epi8(_mm256_min_epu8(letter, alphaSpan), letter);
+            _mm256_storeu_si256((__m256i*)(lower + k + part * 32), _mm256_or_si256(v, _mm256_and_si256(isAl, caseBit)));
+            space |= (uint64_t)(uint32_t)_mm256_movemask_epi8(isSp) << (part * 32);
+            alpha |= (uint64_t)(uint32_t)_mm256_movemask_epi8(isAl) << (part * 32);
+        }
+        spaceBits[k / 64] = space;
+        alphaBits[k / 64] = alpha;
+    }
+    if (k < n) {
+        classifyScalar(src + k, n - k, lower + k, spaceBits + k / 64, alphaBits + k / 64);
+    }
+}
+#endif
+
+// pickClassifier Function: Chooses a tokenizer kernel by name, "auto" picks the widest one this CPU supports
+// - Returns nullptr when the requested kernel is unknown or not supported here
+ClassifyFn pickClassifier(const string& name) {
+#ifdef HAVE_X86_SIMD
+    bool avx2 = __builtin_cpu_supports("avx2");
+    if (name == "avx2") return avx2 ? classifyAVX2 : nullptr;
+    if (name == "sse2") return classifySSE2;
+    if (name == "auto") return avx2 ? classifyAVX2 : classifySSE2;
+#else
+    if (name == "auto") return classifyScalar;
+#endif
+    if (name == "scalar") return classifyScalar;
+    return nullptr;
+}
+
+// Tokenizer kernel used by forEachWord, set once in main before any thread starts
+ClassifyFn classifyBlock = classifyScalar;
+
+// nextBit Function: Index of the first bit at or after "from" that is set (or clear when "set" is false), "n" if none
+inline size_t nextBit(const uint64_t* bits, size_t from, size_t n, bool set) {
+    size_t w = from / 64;
+    size_t words = (n + 63) / 64;
+    if (w >= words) {
+        return n;
+    }
+    uint64_t cur = (set ? bits[w] : ~bits[w]) & (~0ull << (from % 64));
+    while (cur == 0) {
+        if (++w == words) {
+            return n;
+        }
+        cur = set ? bits[w] : ~bits[w];
+    }
+    return min(n, w * 64 + __builtin_ctzll(cur));
+}
+
+// forEachWord Function: Walks a byte range of the mapped file and calls "emit" with every cleaned word
+// 1. The range is handled in windows of about 64 KB that end on whitespace; each window is classified by "classifyBlock"
+// 2. Word boundaries are then found by scanning the whitespace bitmap 64 bytes at a time
+// 3. A word made only of letters is passed as a view into the lowercased window, other words have their letters
+//    compacted into a reused buffer - the result is the same as toLower on every word read by ">>"
+// 4. The view is only valid during the call, so "emit" must copy the word if it wants to keep it
+template <class Emit>
+void forEachWord(string_view range, Emit emit) {
+    const size_t windowSize = 64 << 10;
+
+    vector<char> lower;
+    vector<uint64_t> spaceBits, alphaBits;
+    string cleaned;
+
+    size_t pos = 0;
+    while (pos < range.size()) {
+        size_t end = min(range.size(), pos + windowSize);
+        while (end < range.size() && !isSpace(range[end])) {
+            end++;
+        }
+        size_t n = end - pos;
+        if (lower.size() < n) {
+            lower.resize(n);
+            spaceBits.resize((n + 63) / 64);
+            alphaBits.resize((n + 63) / 64);
+        }
+        classifyBlock(range.data() + pos, n, lower.data(), spaceBits.data(), alphaBits.data());
+
+        size_t i = 0;
+        while (true) {
+            size_t start = nextBit(spaceBits.data(), i, n, false);
+            if (start >= n) {
+                break;
+            }
+            i = nextBit(spaceBits.data(), start, n, true);
+
+            if (nextBit(alphaBits.data(), start, i, false) >= i) {
+                emit(string_view(lower.data() + start, i - start));
+            } else {
+                cleaned.clear();
+                for (size_t k = start; k < i; k++) {
+                    if ((alphaBits[k / 64] >> (k % 64)) & 1) {
+                        cleaned += lower[k];
+                    }
+                }
+                if (!cleaned.empty()) {
+                    emit(string_view(cleaned));
+                }
+            }
+        }
+        pos = end;
+    }
+}
+
+// countChunkMap Function: Map backend task - counts one chunk of the mapped file into the worker's own map in "results"
+// - A new string is only allocated the first time a word is seen by this worker
+// - Every word has been copied into the map once the chunk is done, so its pages are dropped to keep memory flat
+void countChunkMap(int worker, string_view chunk) {
+    WordMap& localCount = results[worker];
+
+    forEachWord(chunk, [&](string_view word) {
+        auto it = localCount.find(word);
+        if (it != localCount.end()) {
+            it->second++;
+        } else {
+            localCount.emplace(word, 1);
+        }
+    });
+
+    releaseConsumed(chunk.data(), chunk.data() + chunk.size());
+}
+
+// hashWord Function: 64-bit FNV-1a hash of a word, never 0 so 0 can mark an empty slot
+inline uint64_t hashWord(string_view word) {
+    uint64_t h = 1469598103934665603ull;
+    for (size_t i = 0; i < word.size(); i++) {
+        h ^= (unsigned char)word[i];
+        h *= 1099511628211ull;
+    }
+    return h == 0 ? 1 : h;
+}
+
+// WordTable Structure: Open addressing (linear probing) hash table owned by a single thread
+// - Word bytes are copied once into large arena blocks, so there is no allocation per distinct word
+// - The table doubles when it gets half full
+struct WordTable {
+    struct Slot {
+        uint64_t hash = 0;
+        const char* key = nullptr;
+        uint32_t len = 0;
+        long long count = 0;
+    };
+
+    vector<Slot> slots;
+    size_t used = 0;
+    vector<unique_ptr<char[]>> blocks;
+    size_t blockLeft = 0;
+    char* blockPos = nullptr;
+
+    WordTable() : slots(1024) {}
+
+    // storeKey Function: Copies a word into the arena and returns a stable pointer to it
+    const char* storeKey(string_view word) {
+        if (word.size() > blockLeft) {
+            size_t blockSize = max<size_t>(word.size(), 64 << 10);
+            blocks.push_back(unique_ptr<char[]>(new char[blockSize]));
+            blockPos = blocks.back().get();
+            blockLeft = blockSize;
+        }
+        char* key = blockPos;
+        memcpy(key, word.data(), word.size());
+        blockPos += word.size();
+        blockLeft -= word.size();
+        return key;
+    }
+
+    // grow Function: Doubles the slot array and re-inserts every word (keys stay in the arena)
+    void grow() {
+        vector<Slot> old(slots.size() * 2);
+        old.swap(slots);
+        size_t mask = slots.size() - 1;
+        for (size_t i = 0; i < old.size(); i++) {
+            if (old[i].hash != 0) {
+                size_t pos = old[i].hash & mask;
+                while (slots[pos].hash != 0) {
+                    pos = (pos + 1) & mask;
+                }
+                slots[pos] = old[i];
+            }
+        }
+    }
+
+    // add Function: Adds "n" to the count of "word", inserting it if it is new
+    void add(string_view word, long long n = 1) {
+        uint64_t h = hashWord(word);
+        size_t mask = slots.size() - 1;
+        size_t pos = h & mask;
+        while (slots[pos].hash != 0) {
+            Slot& s = slots[pos];
+            if (s.hash == h && s.len == word.size() && memcmp(s.key, word.data(), word.size()) == 0) {
+                s.count += n;
+                return;
+            }
+            pos = (pos + 1) & mask;
+        }
+
+        Slot& s = slots[pos];
+        s.hash = h;
+        s.key = storeKey(word);
+        s.len = word.size();
+        s.count = n;
+        used++;
+        if (used * 2 > slots.size()) {
+            grow();
+        }
+    }
+};
+
+// ConcurrentWordTable Structure: Fixed size, lock-free open addressing hash table shared by all threads
+// - A slot is claimed by CAS-ing its hash from 0, then the key pointer is published with release ordering
+// - A thread that finds a claimed slot with the same hash waits for the key before comparing it
+// - Counts are atomic, so threads add to the same word without locking
+// - Keys are not copied: they point into the per-thread WordTable arenas, which must outlive this table
+struct ConcurrentWordTable {
+    struct Slot {
+        atomic<uint64_t> hash{0};
+        atomic<const char*> key{nullptr};
+        uint32_t len = 0;
+        atomic<long long> count{0};
+    };
+
+    unique_ptr<Slot[]> slots;
+    size_t mask;
+
+    // - "capacity" must be an upper bound of the number of distinct words, the table is sized to twice that
+    explicit ConcurrentWordTable(size_t capacity) {
+        size_t size = 1024;
+        while (size < capacity * 2) {
+            size *= 2;
+        }
+        slots.reset(new Slot[size]);
+        mask = size - 1;
+    }
+
+    size_t size() const { return mask + 1; }
+
+    // add Function: Adds "n" to the count of the word stored at "key" (hash "h" and length "len")
+    void add(uint64_t h, const char* key, uint32_t len, long long n) {
+        size_t pos = h & mask;
+        while (true) {
+            Slot& s = slots[pos];
+            uint64_t cur = s.hash.load(memory_order_acquire);
+            if (cur == 0) {
+                if (s.hash.compare_exchange_strong(cur, h, memory_order_acq_rel)) {
+                    s.len = len;
+                    s.key.store(key, memory_order_release);
+                    s.count.fetch_add(n, memory_order_relaxed);
+                    return;
+                }
+                // - Another thread claimed the slot first, "cur" now holds its hash
+            }
+            if (cur == h) {
+                const char* other;
+                while ((other = s.key.load(memory_order_acquire)) == nullptr) {
+                    this_thread::yield();
+                }
+                if (s.len == len && memcmp(other, key, len) == 0) {
+                    s.count.fetch_add(n, memory_order_relaxed);
+                    return;
+                }
+            }
+            pos = (pos + 1) & mask;
+        }
+    }
+};
+
+// Each individual thread stores its hash table here when the hash backend is used
+vector<WordTable> tables;
+
+// countChunkHash Function: Hash backend version of countChunkMap, counts one chunk into the worker's own WordTable
+void countChunkHash(int worker, string_view chunk) {
+    WordTable& localCount = tables[worker];
+
+    forEachWord(chunk, [&](string_view word) {
+        localCount.add(word);
+    });
+
+    releaseConsumed(chunk.data(), chunk.data() + chunk.size());
+}
+
+// printWorkerCounts Function: Prints the word counts gathered by one worker of the byte-range pipeline
+void printWorkerCounts(int worker, bool useHash) {
+    out << "\n[Thread " << worker + 1 << "] word counts for worker " << worker + 1 << ":\n";
+    if (useHash) {
+        const WordTable& localCount = tables[worker];
+        for (size_t i = 0; i < localCount.slots.size(); i++) {
+            const WordTable::Slot& s = localCount.slots[i];
+            if (s.hash != 0) {
+                out << "  " << string_view(s.key, s.len) << ": " << s.count << '\n';
+            }
+        }
+    } else {
+        const WordMap& localCount = results[worker];
+        for (auto it = localCount.begin(); it != localCount.end(); it++) {
+            out << "  " << it->first << ": " << it->second << '\n';
+        }
+    }
+}
 
-    cout << "Enter filename: ";
-    cin >> filename;
-    cout << "Enter number of threads: ";
-    cin >> N;
+// mergeTable Function: Inserts one worker's table into the shared table, run by every worker at the same time
+void mergeTable(const WordTable& local, ConcurrentWordTable& shared) {
+    for (size_t i = 0; i < local.slots.size(); i++) {
+        const WordTable::Slot& s = local.slots[i];
+        if (s.hash != 0) {
+            shared.add(s.hash, s.key, s.len, s.count);
+        }
+    }
+}
+
+// printHashCounts Function: Prints the merged hash table, sorted by word only when asked for
+void printHashCounts(const ConcurrentWordTable& shared, bool sorted, CountWriter& writer) {
+    vector<pair<string_view, long long>> entries;
+    for (size_t i = 0; i < shared.size(); i++) {
+        const ConcurrentWordTable::Slot& s = shared.slots[i];
+        if (s.hash.load(memory_order_relaxed) != 0) {
+            entries.push_back(make_pair(string_view(s.key.load(memory_order_relaxed), s.len), s.count.load(memory_order_relaxed)));
+        }
+    }
+    if (sorted) {
+        sort(entries.begin(), entries.end());
+    }
+    writer.begin("Final Word Counts");
+    for (size_t i = 0; i < entries.size(); i++) {
+        writer.add(entries[i].first, entries[i].second);
+    }
+    writer.end();
+}
+
+// WorkStealingPool Class: Reusable pool of worker threads, each with its own deque of tasks
+// - A worker takes tasks from the front of its own deque, so chunks it was given in file order are read in order
+// - A worker whose deque is empty steals from the back of another worker's deque, the work furthest from that owner
+// - Each worker records how many tasks it ran, how many of them it stole and how long it was busy
+class WorkStealingPool {
+public:
+    typedef function<void(int)> Task;   // receives the index of the worker running it
+
+    struct WorkerStats {
+        long long tasks = 0;
+        long long stolen = 0;
+        double busySeconds = 0;
+    };
 
+    explicit WorkStealingPool(int numWorkers) : started(chrono::steady_clock::now()) {
+        for (int i = 0; i < numWorkers; i++) {
+            workers.push_back(unique_ptr<Worker>(new Worker()));
+        }
+        for (int i = 0; i < numWorkers; i++) {
+            threads.push_back(thread(&WorkStealingPool::workerLoop, this, i));
+        }
+    }
+
+    ~WorkStealingPool() {
+        {
+            lock_guard<mutex> lock(stateMtx);
+            stopping = true;
+        }
+        workReady.notify_all();
+        for (int i = 0; i < threads.size(); i++) {
+            threads[i].join();
+        }
+    }
+
+    int size() const { return workers.size(); }
+
+    // submit Function: Queues a task on the given worker's deque, any idle worker may steal it
+    void submit(int worker, Task task) {
+        {
+            lock_guard<mutex> lock(workers[worker]->m);
+            workers[worker]->tasks.push_back(move(task));
+        }
+        {
+            lock_guard<mutex> lock(stateMtx);
+            queued++;
+            unfinished++;
+        }
+        workReady.notify_one();
+    }
+
+    // wait Function: Blocks until every submitted task has finished
+    void wait() {
+        unique_lock<mutex> lock(stateMtx);
+        allDone.wait(lock, [&] { return unfinished == 0; });
+    }
+
+    // printUtilization Function: Prints tasks, steals and busy time of every worker since the pool was created
+    // - Only valid after wait(), while no tasks are running
+    void printUtilization(ostream& out) const {
+        double wall = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+        out << "\n------ Worker Utilization ------" << endl;
+        out << left << setw(8) << "Worker" << setw(10) << "Tasks" << setw(10) << "Stolen"
+            << setw(12) << "Busy (ms)" << "Utilization" << endl;
+        for (int i = 0; i < workers.size(); i++) {
+            const WorkerStats& s = workers[i]->stats;
+            out << left << setw(8) << i + 1 << setw(10) << s.tasks << setw(10) << s.stolen
+                << setw(12) << fixed << setprecision(1) << s.busySeconds * 1000
+                << setprecision(1) << (wall > 0 ? s.busySeconds / wall * 100 : 0) << "%" << endl;
+        }
+        out << "Wall time: " << fixed << setprecision(1) << wall * 1000 << " ms" << endl;
+        out << right;
+    }
+
+private:
+    struct Worker {
+        mutex m;
+        deque<Task> tasks;
+        WorkerStats stats;
+    };
+
+    // takeTask Function: Pops the front of the worker's own deque, or steals the back of another one
+    bool takeTask(int self, Task& task, bool& stolen) {
+        {
+            lock_guard<mutex> lock(workers[self]->m);
+            if (!workers[self]->tasks.empty()) {
+                task = move(workers[self]->tasks.front());
+                workers[self]->tasks.pop_front();
+                stolen = false;
+                return true;
+            }
+        }
+        for (int k = 1; k < workers.size(); k++) {
+            Worker& victim = *workers[(self + k) % workers.size()];
+            lock_guard<mutex> lock(victim.m);
+            if (!victim.tasks.empty()) {
+                task = move(victim.tasks.back());
+                victim.tasks.pop_back();
+                stolen = true;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // workerLoop Function: Runs tasks until the pool is destroyed, sleeping while there is nothing queued anywhere
+    void workerLoop(int self) {
+        WorkerStats& stats = workers[self]->stats;
+        while (true) {
+            Task task;
+            bool stolen = false;
+            if (!takeTask(self, task, stolen)) {
+                unique_lock<mutex> lock(stateMtx);
+                workReady.wait(lock, [&] { return stopping || queued > 0; });
+                if (stopping && queued == 0) {
+                    return;
+                }
+                continue;
+            }
+            {
+                lock_guard<mutex> lock(stateMtx);
+                queued--;
+            }
+
+            auto t0 = chrono::steady_clock::now();
+            task(self);
+            stats.busySeconds += chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+            stats.tasks++;
+            stats.stolen += stolen;
+
+            bool last;
+            {
+                lock_guard<mutex> lock(stateMtx);
+                last = --unfinished == 0;
+            }
+            if (last) {
+                allDone.notify_all();
+            }
+        }
+    }
+
+    vector<unique_ptr<Worker>> workers;
+    vector<thread> threads;
+    mutex stateMtx;
+    condition_variable workReady, allDone;
+    long long queued = 0;       // tasks sitting in a deque
+    long long unfinished = 0;   // tasks queued or running
+    bool stopping = false;
+    chrono::steady_clock::time_point started;
+};
+
+// SpaceSaving Structure: Space-Saving summary (Metwally et al.) that tracks the most frequent words in fixed memory
+// - Keeps at most "capacity" counters; a word that is not tracked replaces the counter with the smallest count
+//   and inherits that count as its possible overestimate ("error")
+// - For every word: count - error <= true count <= count, and error <= (words seen) / capacity
+// - Counters sit in a min-heap on count, so both updates and replacements are O(log capacity)
+struct SpaceSaving {
+    struct Counter {
+        string word;
+        long long count = 0;
+        long long error = 0;
+    };
+
+    size_t capacity;
+    long long total = 0;                   // words seen, including those merged in from other summaries
+    vector<Counter> counters;              // reserved up front so the views in "index" stay valid
+    vector<int> heap;                      // counter indices, smallest count first
+    vector<int> heapPos;                   // position of each counter in "heap"
+    unordered_map<string_view, int> index; // word -> counter index, keys view counters[i].word
+
+    explicit SpaceSaving(size_t capacity) : capacity(capacity) {
+        counters.reserve(capacity);
+        heap.reserve(capacity);
+        heapPos.reserve(capacity);
+        index.reserve(capacity * 2);
+    }
+
+    SpaceSaving(const SpaceSaving&) = delete;
+    SpaceSaving& operator=(const SpaceSaving&) = delete;
+
+    // siftDown Function: Restores the heap after the counter at heap position "p" grew
+    void siftDown(size_t p) {
+        while (true) {
+            size_t smallest = p;
+            size_t l = 2 * p + 1, r = l + 1;
+            if (l < heap.size() && counters[heap[l]].count < counters[heap[smallest]].count) smallest = l;
+            if (r < heap.size() && counters[heap[r]].count < counters[heap[smallest]].count) smallest = r;
+            if (smallest == p) {
+                return;
+            }
+            swap(heap[p], heap[smallest]);
+            heapPos[heap[p]] = p;
+            heapPos[heap[smallest]] = smallest;
+            p = smallest;
+        }
+    }
+
+    // siftUp Function: Restores the heap after a counter was appended at heap position "p"
+    void siftUp(size_t p) {
+        while (p > 0) {
+            size_t parent = (p - 1) / 2;
+            if (counters[heap[parent]].count <= counters[heap[p]].count) {
+                return;
+            }
+            swap(heap[p], heap[parent]);
+            heapPos[heap[p]] = p;
+            heapPos[heap[parent]] = parent;
+            p = parent;
+        }
+    }
+
+    // minCount Function: Smallest tracked count, the most an untracked word can have been seen (0 while not full)
+    long long minCount() const {
+        return counters.size() < capacity ? 0 : counters[heap[0]].count;
+    }
+
+    // add Function: Counts "n" more occurrences of "word" (with an inherited overestimate of "error")
+    void add(string_view word, long long n = 1, long long error = 0) {
+        auto it = index.find(word);
+        if (it != index.end()) {
+            Counter& c = counters[it->second];
+            c.count += n;
+            c.error += error;
+            siftDown(heapPos[it->second]);
+            return;
+        }
+
+        if (counters.size() < capacity) {
+            int slot = counters.size();
+            counters.push_back(Counter());
+            counters[slot].word.assign(word);
+            counters[slot].count = n;
+            counters[slot].error = error;
+            index.emplace(string_view(counters[slot].word), slot);
+            heap.push_back(slot);
+            heapPos.push_back(heap.size() - 1);
+            siftUp(heap.size() - 1);
+            return;
+        }
+
+        // - Full: the word takes over the smallest counter
+        int slot = heap[0];
+        Counter& c = counters[slot];
+        index.erase(string_view(c.word));
+        c.word.assign(word);
+        c.error = c.count + error;
+        c.count += n;
+        index.emplace(string_view(c.word), slot);
+        siftDown(0);
+    }
+
+    // merge Function: Folds another summary into this one (mergeable summaries, Agarwal et al.)
+    // - A word missing from one summary is charged that summary's minimum count, both as count and as error
+    // - The largest "capacity" of the combined counters are kept, so the bound error <= total / capacity still holds
+    void merge(const SpaceSaving& other) {
+        long long minA = minCount(), minB = other.minCount();
+        unordered_map<string_view, Counter> combined;
+        combined.reserve((counters.size() + other.counters.size()) * 2);
+        for (const Counter& c : counters) {
+            Counter& m = combined[c.word];
+            m.count = c.count + minB;
+            m.error = c.error + minB;
+        }
+        for (const Counter& c : other.counters) {
+            auto it = combined.find(c.word);
+            if (it != combined.end()) {
+                it->second.count += c.count - minB;
+                it->second.error += c.error - minB;
+            } else {
+                Counter& m = combined[c.word];
+                m.count = c.count + minA;
+                m.error = c.error + minA;
+            }
+        }
+
+        vector<Counter> merged;
+        merged.reserve(combined.size());
+        for (auto& entry : combined) {
+            entry.second.word.assign(entry.first);
+            merged.push_back(move(entry.second));
+        }
+        if (merged.size() > capacity) {
+            nth_element(merged.begin(), merged.begin() + capacity, merged.end(),
+                        [](const Counter& a, const Counter& b) { return a.count > b.count; });
+            merged.resize(capacity);
+        }
+
+        long long newTotal = total + other.total;
+        index.clear();
+        counters.clear();
+        heap.clear();
+        heapPos.clear();
+        for (Counter& c : merged) {
+            add(c.word, c.count, c.error);
+        }
+        total = newTotal;
+    }
+
+    // top Function: The "k" largest counters, most frequent first (ties by word)
+    vector<Counter> top(size_t k) const {
+        vector<Counter> sorted(counters.begin(), counters.end());
+        sort(sorted.begin(), sorted.end(), [](const Counter& a, const Counter& b) {
+            return a.count != b.count ? a.count > b.count : a.word < b.word;
+        });
+        if (sorted.size() > k) {
+            sorted.resize(k);
+        }
+        return sorted;
+    }
+};
+
+// Each individual worker keeps its own summary here when the top-K streaming mode is used
+vector<unique_ptr<SpaceSaving>> sketches;
+
+// countBlockTopK Function: Top-K task - counts one block of the stream into the worker's own summary
+void countBlockTopK(int worker, const string& block) {
+    SpaceSaving& sketch = *sketches[worker];
+    forEachWord(block, [&](string_view word) {
+        sketch.add(word);
+        sketch.total++;
+    });
+}
+
+// printTopK Function: Merges copies of every worker's summary and prints the "k" most frequent words
+// - Only called while no block is being counted
+void printTopK(int k, const string& format) {
+    SpaceSaving merged(sketches[0]->capacity);
+    for (int i = 0; i < sketches.size(); i++) {
+        merged.merge(*sketches[i]);
+    }
+
+    CountWriter writer(format, true);
+    writer.begin("Top " + to_string(k) + " Words");
+    vector<SpaceSaving::Counter> best = merged.top(k);
+    for (int i = 0; i < best.size(); i++) {
+        writer.add(best[i].word, best[i].count, best[i].error);
+    }
+    if (format == "text") {
+        out << "Words counted: " << merged.total << ", counters: " << (long long)merged.capacity
+            << ", error bound: " << merged.total / (long long)merged.capacity << '\n';
+    }
+    writer.end(merged.total);
+}
+
+// benchTokenizer Function: Measures the throughput of every tokenizer in MB/s on "filename"
+// - The original getline + stringstream + toLower path is the reference
+// - Every kernel must produce the same word count and the same order-independent checksum as the reference
+bool benchTokenizer(const string& filename) {
+    MappedFile mf;
+    if (!mapFile(filename, mf)) {
+        cout << "Error: could not open file" << endl;
+        return false;
+    }
+    string_view data(mf.data, mf.size);
+    double megabytes = mf.size / (1024.0 * 1024.0);
+
+    const int rounds = 3;
+    cout << fixed << setprecision(1);
+    cout << "Input: " << filename << " (" << megabytes << " MB), best of " << rounds << " runs" << endl;
+
+    // - Reference: the original per-line stringstream and toLower
+    unsigned long long refWords = 0, refSum = 0;
+    double best = 1e30;
+    for (int r = 0; r < rounds; r++) {
+        auto t0 = chrono::steady_clock::now();
+        unsigned long long words = 0;
+        ifstream in(filename);
+        string line;
+        while (getline(in, line)) {
+            stringstream ss(line);
+            string word;
+            while (ss >> word) {
+                string cleaned = toLower(word);
+                if (cleaned != "") {
+                    words++;
+                }
+            }
+        }
+        best = min(best, chrono::duration<double>(chrono::steady_clock::now() - t0).count());
+        refWords = words;
+        if (r == 0) {
+            // - Checksum pass, outside the timed runs
+            ifstream check(filename);
+            while (check >> line) {
+                string cleaned = toLower(line);
+                if (cleaned != "") {
+                    refSum += hashWord(cleaned);
+                }
+            }
+        }
+    }
+    cout << "  " << left << setw(22) << "stringstream+toLower" << right << setw(10) << megabytes / best << " MB/s  "
+         << refWords << " words" << endl;
+
+    const char* kernels[] = {"scalar", "sse2", "avx2"};
+    bool allMatch = true;
+    for (const char* name : kernels) {
+        ClassifyFn fn = pickClassifier(name);
+        if (fn == nullptr) {
+            cout << "  " << left << setw(22) << name << right << "  not supported on this CPU" << endl;
+            continue;
+        }
+        classifyBlock = fn;
+
+        // - Timed runs only count words and letters so the kernel itself is measured
+        unsigned long long words = 0, letters = 0, sum = 0;
+        best = 1e30;
+        for (int r = 0; r < rounds; r++) {
+            auto t0 = chrono::steady_clock::now();
+            words = 0;
+            letters = 0;
+            forEachWord(data, [&](string_view word) {
+                words++;
+                letters += word.size();
+            });
+            best = min(best, chrono::duration<double>(chrono::steady_clock::now() - t0).count());
+        }
+        forEachWord(data, [&](string_view word) {
+            sum += hashWord(word);
+        });
+        bool match = words == refWords && sum == refSum;
+        allMatch = allMatch && match;
+        cout << "  " << left << setw(22) << name << right << setw(10) << megabytes / best << " MB/s  "
+             << words << " words" << (match ? "" : "  MISMATCH") << endl;
+    }
+
+    unmapFile(mf);
+    return allMatch;
+}
+
+// parseSize Function: Parses a byte count such as "65536", "64K" or "4M"
+bool parseSize(const string& text, size_t& bytes) {
+    char* end = nullptr;
+    unsigned long long value = strtoull(text.c_str(), &end, 10);
+    string suffix = end;
+    if (suffix == "K" || suffix == "k") {
+        value <<= 10;
+    } else if (suffix == "M" || suffix == "m") {
+        value <<= 20;
+    } else if (!suffix.empty()) {
+        return false;
+    }
+    if (end == text.c_str() || value == 0) {
+        return false;
+    }
+    bytes = value;
+    return true;
+}
+
+// parseArgs Function: Reads the optional command line flags into "opts"
+bool parseArgs(int argc, char* argv[], Options& opts) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if ((arg == "-i" || arg == "--input") && i + 1 < argc) {
+            opts.input = argv[++i];
+        } else if ((arg == "-t" || arg == "--threads") && i + 1 < argc) {
+            opts.threads = atoi(argv[++i]);
+            if (opts.threads < 1) {
+                cerr << "Error: --threads must be at least 1" << endl;
+                return false;
+            }
+        } else if (arg == "--format" && i + 1 < argc) {
+            opts.format = argv[++i];
+        } else if (arg == "-q" || arg == "--quiet") {
+            opts.quiet = true;
+        } else if (arg == "--mmap") {
+            opts.useMmap = true;
+        } else if (arg == "--backend" && i + 1 < argc) {
+            opts.backend = argv[++i];
+        } else if (arg == "--sorted") {
+            opts.sorted = true;
+        } else if (arg == "--tokenizer" && i + 1 < argc) {
+            opts.tokenizer = argv[++i];
+        } else if (arg == "--bench-tokenizer" && i + 1 < argc) {
+            opts.benchFile = argv[++i];
+        } else if (arg == "--topk" && i + 1 < argc) {
+            opts.topK = atoi(argv[++i]);
+            if (opts.topK < 1) {
+                cerr << "Error: --topk must be at least 1" << endl;
+                return false;
+            }
+        } else if (arg == "--epsilon" && i + 1 < argc) {
+            opts.epsilon = atof(argv[++i]);
+            if (!(opts.epsilon > 0 && opts.epsilon < 1)) {
+                cerr << "Error: --epsilon must be between 0 and 1" << endl;
+                return false;
+            }
+        } else if (arg == "--report-every" && i + 1 < argc) {
+            opts.reportEvery = atof(argv[++i]);
+        } else if (arg == "--chunk-size" && i + 1 < argc) {
+            if (!parseSize(argv[++i], opts.chunkSize)) {
+                cerr << "Error: chunk size must be a positive number of bytes, optionally followed by K or M" << endl;
+                return false;
+            }
+        } else {
+            cerr << "Unknown option: " << arg << endl;
+            cerr << "Usage: " << argv[0] << " [-i FILE] [-t THREADS] [--format text|csv|json|binary] [-q]" << endl;
+            cerr << "       " << "  [--mmap] [--backend map|hash] [--sorted] [--tokenizer auto|scalar|sse2|avx2]"
+                 << " [--chunk-size BYTES[K|M]]" << endl;
+            cerr << "       " << argv[0] << " --topk K [--epsilon E] [--report-every SECONDS]   (filename \"-\" reads stdin)" << endl;
+            cerr << "       " << argv[0] << " --bench-tokenizer FILE" << endl;
+            return false;
+        }
+    }
+
+    classifyBlock = pickClassifier(opts.tokenizer);
+    if (classifyBlock == nullptr) {
+        cerr << "Error: tokenizer \"" << opts.tokenizer << "\" is not available on this CPU" << endl;
+        return false;
+    }
+
+    if (opts.format != "text" && opts.format != "csv" && opts.format != "json" && opts.format != "binary") {
+        cerr << "Error: format must be text, csv, json or binary" << endl;
+        return false;
+    }
+    // - Only the final counts are machine readable, so the per-thread dumps are text-only
+    showSegments = !opts.quiet && opts.format == "text";
+
+    if (opts.backend != "map" && opts.backend != "hash") {
+        cerr << "Error: backend must be \"map\" or \"hash\"" << endl;
+        return false;
+    }
+    // - The hash backend only runs on the byte-range pipeline
+    if (opts.backend == "hash") {
+        opts.useMmap = true;
+    }
+    return true;
+}
+
+// runLines Function: Original pipeline - reads the file line by line and hands each thread a round robin segment of lines
+bool runLines(const string& filename, int N) {
     ifstream file(filename);
     if (!file.is_open()) {
         cout << "Error: could not open file" << endl;
-        return 1;
+        return false;
     }
 
     vector<string> lines;
@@ -100,19 +1278,211 @@ int main() {
     for (int i = 0; i < threads.size(); i++) {
         threads[i].join();
     }
+    return true;
+}
+
+// runMapped Function: Zero-copy pipeline - maps the file and counts it on a work-stealing pool of "N" workers
+// 1. The file is cut into fixed-size chunks and each worker is given a contiguous run of them, keeping reads sequential
+// 2. A worker that runs out of chunks steals from the back of a busy worker's run, so skewed inputs keep every core busy
+// 3. Each worker counts into its own map or hash table; with the hash backend the tables are then merged on the same pool
+bool runMapped(const string& filename, int N, const Options& opts) {
+    MappedFile mf;
+    if (!mapFile(filename, mf)) {
+        cout << "Error: could not open file" << endl;
+        return false;
+    }
+    if (N < 1) {
+        N = 1;
+    }
+
+    vector<string_view> chunks = splitChunks(string_view(mf.data, mf.size), opts.chunkSize);
+    bool useHash = opts.backend == "hash";
+    if (useHash) {
+        tables.clear();
+        tables.resize(N);
+    } else {
+        results.assign(N, WordMap());
+    }
+
+    WorkStealingPool pool(N);
+    for (size_t c = 0; c < chunks.size(); c++) {
+        string_view chunk = chunks[c];
+        int owner = c * N / chunks.size();
+        if (useHash) {
+            pool.submit(owner, [chunk](int worker) { countChunkHash(worker, chunk); });
+        } else {
+            pool.submit(owner, [chunk](int worker) { countChunkMap(worker, chunk); });
+        }
+    }
+    pool.wait();
+    unmapFile(mf);
+
+    if (showSegments) {
+        for (int i = 0; i < N; i++) {
+            printWorkerCounts(i, useHash);
+        }
+    }
+
+    if (useHash) {
+        // - The sum of the per-worker distinct counts bounds the merged distinct count, so the shared table never fills up
+        size_t capacity = 0;
+        for (int i = 0; i < N; i++) {
+            capacity += tables[i].used;
+        }
+        ConcurrentWordTable shared(capacity);
+
+        // Merging of results - every worker inserts one table into the shared one at the same time
+        for (int i = 0; i < N; i++) {
+            pool.submit(i, [i, &shared](int) { mergeTable(tables[i], shared); });
+        }
+        pool.wait();
+        if (!opts.quiet) {
+            pool.printUtilization(cerr);
+        }
+
+        CountWriter writer(opts.format, false);
+        printHashCounts(shared, opts.sorted, writer);
+    } else if (!opts.quiet) {
+        pool.printUtilization(cerr);
+    }
+    return true;
+}
+
+// runStreaming Function: Bounded-memory top-K pipeline over a file, a pipe or stdin ("-")
+// 1. The input is read in blocks of "chunkSize" bytes; the partial word at the end of a block is carried into the next
+// 2. Blocks are counted on the work-stealing pool, each worker into its own Space-Saving summary of 1 / epsilon counters
+// 3. At most two blocks per worker are in flight, so memory does not depend on the input size or its vocabulary
+// 4. The summaries are merged at the end, and every "reportEvery" seconds when running over a long stream
+bool runStreaming(istream& in, int N, const Options& opts) {
+    if (N < 1) {
+        N = 1;
+    }
+    size_t capacity = max<size_t>(opts.topK, (size_t)ceil(1.0 / opts.epsilon));
+    sketches.clear();
+    for (int i = 0; i < N; i++) {
+        sketches.push_back(unique_ptr<SpaceSaving>(new SpaceSaving(capacity)));
+    }
+
+    mutex blockMtx;
+    condition_variable blockFree;
+    int inFlight = 0;
+    const int maxInFlight = 2 * N;
+
+    WorkStealingPool pool(N);
+    auto lastReport = chrono::steady_clock::now();
+    string carry;
+    int next = 0;
+    while (in) {
+        auto block = make_shared<string>(move(carry));
+        carry = string();
+        size_t have = block->size();
+        block->resize(have + opts.chunkSize);
+        in.read(&(*block)[have], opts.chunkSize);
+        block->resize(have + in.gcount());
+
+        // - Hold back the unfinished last word, unless this is the end of the input
+        if (in) {
+            size_t cut = block->size();
+            while (cut > 0 && !isSpace((*block)[cut - 1])) {
+                cut--;
+            }
+            carry.assign(*block, cut, string::npos);
+            block->resize(cut);
+        }
+        if (block->empty()) {
+            continue;
+        }
+
+        {
+            unique_lock<mutex> lock(blockMtx);
+            blockFree.wait(lock, [&] { return inFlight < maxInFlight; });
+            inFlight++;
+        }
+        pool.submit(next, [block, &blockMtx, &blockFree, &inFlight](int worker) {
+            countBlockTopK(worker, *block);
+            {
+                lock_guard<mutex> lock(blockMtx);
+                inFlight--;
+            }
+            blockFree.notify_one();
+        });
+        next = (next + 1) % N;
+
+        if (opts.reportEvery > 0 &&
+            chrono::duration<double>(chrono::steady_clock::now() - lastReport).count() >= opts.reportEvery) {
+            pool.wait();
+            printTopK(opts.topK, opts.format);
+            lastReport = chrono::steady_clock::now();
+        }
+    }
+    pool.wait();
+    if (!opts.quiet) {
+        pool.printUtilization(cerr);
+    }
+
+    printTopK(opts.topK, opts.format);
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    Options opts;
+    if (!parseArgs(argc, argv, opts)) {
+        return 1;
+    }
+    if (!opts.benchFile.empty()) {
+        return benchTokenizer(opts.benchFile) ? 0 : 1;
+    }
+
+    // - Anything not given on the command line is asked for, as before
+    string filename = opts.input;
+    int N = opts.threads;
+    if (filename.empty()) {
+        cout << "Enter filename: ";
+        cin >> filename;
+    }
+    if (N == 0) {
+        if (opts.input.empty()) {
+            cout << "Enter number of threads: ";
+            cin >> N;
+        } else {
+            N = max(1u, thread::hardware_concurrency());
+        }
+    }
+
+    if (opts.topK > 0) {
+        if (filename == "-") {
+            return runStreaming(cin, N, opts) ? 0 : 1;
+        }
+        ifstream file(filename, ios::binary);
+        if (!file.is_open()) {
+            cout << "Error: could not open file" << endl;
+            return 1;
+        }
+        return runStreaming(file, N, opts) ? 0 : 1;
+    }
+
+    bool ok = opts.useMmap ? runMapped(filename, N, opts) : runLines(filename, N);
+    if (!ok) {
+        return 1;
+    }
+    if (opts.backend == "hash") {
+        return 0;
+    }
 
     // Merging of results
-    cout << "\n------ Final Word Counts ------" << endl;
-    map<string, int> finalCount;
+    WordMap finalCount;
     for (int i = 0; i < results.size(); i++) {
         for (auto it = results[i].begin(); it != results[i].end(); it++) {
             finalCount[it->first] += it->second;
         }
     }
 
+    CountWriter writer(opts.format, false);
+    writer.begin("Final Word Counts");
     for (auto it = finalCount.begin(); it != finalCount.end(); it++) {
-        cout << it->first << ": " << it->second << endl;
+        writer.add(it->first, it->second);
     }
+    writer.end();
 
     return 0;
 }
\ No newline at end of file